@@ -100,16 +100,17 @@ int main(int argc, char *argv[]) {
     });
 
     auto sevr_color = [&]() -> Decorator{
-        if (sevr.value().choice.find("MAJOR") != std::string::npos) {
+        if (sevr.value().choice().find("MAJOR") != std::string::npos) {
             return EPICSColor::custom(sevr, color(Color::Red));
-        } else if (sevr.value().choice.find("WARN") != std::string::npos) {
+        } else if (sevr.value().choice().find("WARN") != std::string::npos) {
             return EPICSColor::custom(sevr, color(Color::Orange1));
         } else {
             return EPICSColor::readback(sevr);
         }
     };
 
-    // ftxui renderer defines the visual layout
+    // ftxui renderer defines the visual layout. Readbacks are cached by their widget
+    // and only rebuilt when their PV changes
     auto main_renderer = Renderer(main_container, [&] {
         return vbox({
             text(app.args.macros.at("P") + app.args.macros.at("R"))
@@ -131,21 +132,26 @@ int main(int argc, char *argv[]) {
                 separatorEmpty(),
                 oeos.component()->Render() | EPICSColor::edit(oeos) | size(WIDTH, EQUAL, 5),
                 separatorEmpty(),
-                text(nawt.value()) | color(Color::Black) | size(WIDTH, EQUAL, 3),
+                nawt.cached([&] { return text(nawt.value()) | color(Color::Black); }) | size(WIDTH, EQUAL, 3),
             }),
             separatorEmpty(),
             hbox({
                 text(" In: ") | color(Color::Black),
-                text(tinp.value()) | bgcolor(Color::RGB(220,220,220)) | EPICSColor::readback(tinp) | xflex,
+                tinp.cached([&] {
+                    return text(tinp.value()) | bgcolor(Color::RGB(220,220,220)) | EPICSColor::readback(tinp);
+                }) | xflex,
                 separatorEmpty(),
                 ieos.component()->Render() | EPICSColor::edit(ieos) | size(WIDTH, EQUAL, 5),
                 separatorEmpty(),
-                text(nord.value()) | color(Color::Black) | size(WIDTH, EQUAL, 3),
+                nord.cached([&] { return text(nord.value()) | color(Color::Black); }) | size(WIDTH, EQUAL, 3),
             }),
             separator(),
             hbox({
                 text("Err: ") | color(Color::Black),
-                paragraph(errs.value()) | bgcolor(Color::RGB(220,220,220)) | EPICSColor::readback(errs) | xflex,
+                errs.cached([&] {
+                    return paragraph(errs.value()) | bgcolor(Color::RGB(220,220,220))
+                        | EPICSColor::readback(errs);
+                }) | xflex,
             }),
             separatorEmpty(),
             hbox({
@@ -158,10 +164,10 @@ int main(int argc, char *argv[]) {
             separatorEmpty(),
             hbox({
                 text("I/O Status: ") | color(Color::Black),
-                text(stat.value().choice) | EPICSColor::readback(stat),
+                stat.cached([&] { return text(stat.value().choice()) | EPICSColor::readback(stat); }),
                 filler(),
                 text("I/O Severity: ") | color(Color::Black),
-                text(sevr.value().choice) | sevr_color()
+                sevr.cached([&] { return text(sevr.value().choice()) | sevr_color(); })
             }),
 
             separator(),
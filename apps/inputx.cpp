@@ -3,9 +3,6 @@
 #include <pva/client.h>
 
 #include <ftxui/component/component.hpp>
-#include <ftxui/component/loop.hpp>
-#include <ftxui/component/event.hpp>
-#include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/dom/elements.hpp>
 #include <ftxui/screen/color.hpp>
 
@@ -43,6 +40,9 @@ int main(int argc, char *argv[]) {
 
     if (args.help(CLI_HELP_MSG)) return EXIT_SUCCESS;
 
+    // Start the EPICS client and the terminal screen
+    App app(argc, argv);
+
     if (args.macros.empty()) {
         printf("Missing required macros\n");
         return EXIT_FAILURE;
@@ -74,24 +74,13 @@ int main(int argc, char *argv[]) {
         rbv_pvs.push_back(rbv_pv_name);
     }
 
-    // Create the FTXUI screen. Interactive and uses the full terminal screen
-    auto screen = ScreenInteractive::Fullscreen();
-
-    // Instantiate EPICS PVA client
-    // Start CAClientFactory so we can see CA only PVs
-    epics::pvAccess::ca::CAClientFactory::start();
-    pvac::ClientProvider provider(args.provider);
-
-    // PVGroup to manage all PVs for displays
-    PVGroup pvgroup(provider);
-
     // Create input widgets for the set PVs and Monitor<std::string> for the readback PVs
     // We use strings for everything here because it should work for most (all?) PV types
     std::vector<std::unique_ptr<InputWidget>> val_widgets;
     std::vector<std::unique_ptr<Monitor<std::string>>> rbv_widgets;
     for (size_t i = 0; i < val_pvs.size(); i++) {
-        val_widgets.emplace_back(std::make_unique<InputWidget>(pvgroup, val_pvs.at(i), PVPutType::String));
-        rbv_widgets.emplace_back(std::make_unique<Monitor<std::string>>(pvgroup, rbv_pvs.at(i)));
+        val_widgets.emplace_back(std::make_unique<InputWidget>(app.pvgroup, val_pvs.at(i), PVPutType::String));
+        rbv_widgets.emplace_back(std::make_unique<Monitor<std::string>>(app.pvgroup, rbv_pvs.at(i)));
     }
 
     // Add components to a main container.
@@ -136,13 +125,5 @@ int main(int argc, char *argv[]) {
     });
 
     // main program loop
-    constexpr int POLL_PERIOD_MS = 100;
-    Loop loop(&screen, main_renderer);
-    while (!loop.HasQuitted()) {
-        if (pvgroup.sync()) {
-            screen.PostEvent(Event::Custom);
-        }
-        loop.RunOnce();
-        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_PERIOD_MS));
-    }
+    app.run(main_renderer);
 }
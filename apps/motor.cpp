@@ -1,9 +1,6 @@
 #include <charconv>
 
 #include <ftxui/component/component.hpp>
-#include <ftxui/component/event.hpp>
-#include <ftxui/component/loop.hpp>
-#include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/dom/elements.hpp>
 #include <ftxui/screen/color.hpp>
 
@@ -42,6 +39,9 @@ int main(int argc, char* argv[]) {
     if (args.help(CLI_HELP_MSG))
         return EXIT_SUCCESS;
 
+    // Start the EPICS client and the terminal screen
+    App app(argc, argv);
+
     if (not args.macros_present({"P"})) {
         printf("Missing required macro P\n");
         return EXIT_FAILURE;
@@ -59,19 +59,9 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
-    // Create the FTXUI screen. Interactive and uses the full terminal screen
-    auto screen = ScreenInteractive::Fullscreen();
-
-    // Instantiate EPICS PVA client and CAClientFactory to see CA only PVs
-    epics::pvAccess::ca::CAClientFactory::start();
-    pvac::ClientProvider provider(args.provider);
-
     // unique_ptr's to DisplayBase for each screen
     std::vector<std::unique_ptr<DisplayBase>> displays;
 
-    // PVGroup to manage all PVs for displays
-    PVGroup pvgroup(provider);
-
     // multi display creates a SmallMotorDisplay for each Mn macro where n is an integer.
     // The resulting screen is similar to motorNx.adl
     std::vector<int> motor_num_vec;
@@ -93,16 +83,22 @@ int main(int argc, char* argv[]) {
             auto args_n = args;
             args_n.macros["M"] = args_n.macros.at("M" + std::to_string(v));
             args_vec.push_back(args_n);
-            displays.emplace_back(std::make_unique<SmallMotorDisplay>(pvgroup, args_n));
+            displays.emplace_back(std::make_unique<SmallMotorDisplay>(app.pvgroup, args_n));
         }
     } else {
-        displays.emplace_back(std::make_unique<SmallMotorDisplay>(pvgroup, args));
-        displays.emplace_back(std::make_unique<MediumMotorDisplay>(pvgroup, args));
-        displays.emplace_back(std::make_unique<AllMotorDisplay>(pvgroup, args));
+        displays.emplace_back(std::make_unique<SmallMotorDisplay>(app.pvgroup, args));
+        displays.emplace_back(std::make_unique<MediumMotorDisplay>(app.pvgroup, args));
+        displays.emplace_back(std::make_unique<AllMotorDisplay>(app.pvgroup, args));
     }
 
     int selected = 0;
     std::vector<std::string> labels = {"Small", "Medium", "All"};
+
+    // Only the selected view connects and monitors its PVs
+    for (size_t i = 1; !display_multi && i < displays.size(); i++) {
+        displays[i]->deactivate();
+    }
+    int active = selected;
     auto dropdown_op = ftxui::DropdownOption();
     dropdown_op.radiobox.entries = &labels;
     dropdown_op.radiobox.selected = &selected;
@@ -145,6 +141,12 @@ int main(int argc, char* argv[]) {
         main_container = ftxui::Container::Vertical({ftxui::Container::Tab({tabs}, &selected), view_select});
 
         main_renderer = ftxui::Renderer(main_container, [&] {
+            if (selected != active) {
+                // activate first so PVs shared by both views keep their monitors
+                displays.at(selected)->activate();
+                displays.at(active)->deactivate();
+                active = selected;
+            }
             Elements elements;
             elements.push_back(displays.at(selected)->get_renderer());
             elements.push_back(view_select->Render() | color(Color::White) | bgcolor(Color::DarkGreen) |
@@ -155,13 +157,5 @@ int main(int argc, char* argv[]) {
         });
     }
 
-    constexpr int POLL_PERIOD_MS = 100;
-    Loop loop(&screen, main_renderer);
-    while (!loop.HasQuitted()) {
-        if (pvgroup.sync()) {
-            screen.PostEvent(Event::Custom);
-        }
-        loop.RunOnce();
-        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_PERIOD_MS));
-    }
+    app.run(main_renderer);
 }
@@ -20,7 +20,9 @@ SmallMotorDisplay::SmallMotorDisplay(pvtui::PVGroup &pvgroup, const pvtui::ArgPa
     able(pvgroup, args, "$(P)$(M)_able", pvtui::ChoiceStyle::Horizontal),
     use_set(pvgroup, args, "$(P)$(M).SET", pvtui::ChoiceStyle::Horizontal),
     stop(pvgroup, args, "$(P)$(M).STOP", " STOP ")
-{}
+{
+    end_construction();
+}
 
 ftxui::Component SmallMotorDisplay::get_container() {
     using namespace ftxui;
@@ -115,7 +117,9 @@ MediumMotorDisplay::MediumMotorDisplay(pvtui::PVGroup &pvgroup, const pvtui::Arg
     dllm(pvgroup, args, "$(P)$(M).DLLM", pvtui::PVPutType::Double),
     spmg(pvgroup, args, "$(P)$(M).SPMG", pvtui::ChoiceStyle::Vertical),
     able(pvgroup, args, "$(P)$(M)_able", pvtui::ChoiceStyle::Horizontal)
-{}
+{
+    end_construction();
+}
 
 ftxui::Component MediumMotorDisplay::get_container() {
     using namespace ftxui;
@@ -257,7 +261,9 @@ AllMotorDisplay::AllMotorDisplay(pvtui::PVGroup &pvgroup, const pvtui::ArgParser
     cnen(pvgroup, args, "$(P)$(M).CNEN", pvtui::ChoiceStyle::Horizontal),
     foff(pvgroup, args, "$(P)$(M).FOFF", pvtui::ChoiceStyle::Dropdown),
     rrbv(pvgroup, args, "$(P)$(M).RRBV")
-{}
+{
+    end_construction();
+}
 
 ftxui::Component AllMotorDisplay::get_container() {
     using namespace ftxui;
@@ -29,7 +29,7 @@ Options:
 For more details, visit: https://github.com/BCDA-APS/pvtui
 )";
 
-std::vector<double> downsample_and_clip(const std::vector<double>& input, int target_size, double curr_min, double curr_max, double height) {
+std::vector<double> downsample_and_clip(const ArrayView<double>& input, int target_size, double curr_min, double curr_max, double height) {
     std::vector<double> result;
     double chunk_size = static_cast<double>(input.size()) / target_size;
 
@@ -93,14 +93,9 @@ int main(int argc, char *argv[]) {
     Monitor<std::string> next_fill_cont(app, "OPS:message17");
     Monitor<std::string> next_update(app, "OPS:message18");
 
-    // Monitor does not work right here since there isn't a way to preallocate 1440
-    std::vector<double> user_ops_current(1440, 0.0);
-    app.pvgroup.add("S:UserOpsCurrent");
-    app.pvgroup.set_monitor("S:UserOpsCurrent", user_ops_current);
-
-    std::vector<double> other_current(1440, 0.0);
-    app.pvgroup.add("S:OtherCurrent");
-    app.pvgroup.set_monitor("S:OtherCurrent", other_current);
+    // 1440 point histories, shared with the monitor rather than copied on each update
+    Monitor<ArrayView<double>> user_ops_current(app, "S:UserOpsCurrent");
+    Monitor<ArrayView<double>> other_current(app, "S:OtherCurrent");
 
     auto plot1_renderer = Renderer([&] {
         const double CURR_MAX = 200;
@@ -108,15 +103,15 @@ int main(int argc, char *argv[]) {
         const double TARGET_HEIGHT = 50;
         const int TARGET_WIDTH = 100;
         auto c = Canvas(TARGET_WIDTH, TARGET_HEIGHT);
-        std::vector<double> comp_user = downsample_and_clip(user_ops_current, TARGET_WIDTH, CURR_MIN, CURR_MAX, TARGET_HEIGHT);
-        std::vector<double> comp_other = downsample_and_clip(other_current, TARGET_WIDTH, CURR_MIN, CURR_MAX, TARGET_HEIGHT);
+        std::vector<double> comp_user = downsample_and_clip(user_ops_current.value(), TARGET_WIDTH, CURR_MIN, CURR_MAX, TARGET_HEIGHT);
+        std::vector<double> comp_other = downsample_and_clip(other_current.value(), TARGET_WIDTH, CURR_MIN, CURR_MAX, TARGET_HEIGHT);
 
         // "user" current
         std::vector<int> y1(comp_user.size());
         for (size_t x = 0; x < comp_user.size(); x++) {
             y1[x] = static_cast<int>(TARGET_HEIGHT-(comp_user.at(x)));
         }
-        for (size_t x = 1; x < comp_user.size()-1; x++) {
+        for (size_t x = 1; x + 1 < comp_user.size(); x++) {
             c.DrawPointLine(x, y1[x], x + 1, y1[x + 1], Color::Blue);
         }
 
@@ -125,7 +120,7 @@ int main(int argc, char *argv[]) {
         for (size_t x = 0; x < comp_other.size(); x++) {
             y2[x] = static_cast<int>(TARGET_HEIGHT-(comp_other.at(x)));
         }
-        for (size_t x = 1; x < comp_other.size()-1; x++) {
+        for (size_t x = 1; x + 1 < comp_other.size(); x++) {
             c.DrawPointLine(x, y2[x], x + 1, y2[x + 1], Color::Red);
         }
 
@@ -169,8 +164,8 @@ int main(int argc, char *argv[]) {
             shutter_status_text.count(shutter_status.value().index)
                 ? shutter_status_text.at(shutter_status.value().index)
                 : text(""),
-            text("Machine Status: " + desired_mode.value().choice),
-            text("Operating Mode: " + actual_mode.value().choice),
+            text("Machine Status: " + desired_mode.value().choice()),
+            text("Operating Mode: " + actual_mode.value().choice()),
             text("Shutters Open: " + std::to_string(num_shutters_open.value())),
 
             separatorEmpty(),
@@ -0,0 +1,193 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <typeindex>
+#include <unordered_map>
+
+#include <pv/pvData.h>
+#include <pvtui/pvtui.hpp>
+
+// Measures heap allocations and time per monitor event for the MonitorSlots
+// update/sync path. The "legacy" numbers replicate the previous implementation,
+// which copied every slot out of and back into an unordered_map on each event.
+
+namespace pvd = epics::pvData;
+
+static std::atomic<size_t> g_allocs{0};
+
+void* operator new(std::size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr int N_EVENTS = 100000;
+
+pvd::PVStructurePtr make_scalar() {
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->add("value", pvd::pvDouble)
+                    ->addNestedStructure("display")
+                    ->add("format", pvd::pvString)
+                    ->endNested()
+                    ->createStructure();
+    auto pstruct = pvd::getPVDataCreate()->createPVStructure(type);
+    pstruct->getSubFieldT<pvd::PVString>("display.format")->put("F8.3");
+    return pstruct;
+}
+
+pvd::PVStructurePtr make_waveform(size_t length) {
+    auto type =
+        pvd::getFieldCreate()->createFieldBuilder()->addArray("value", pvd::pvDouble)->createStructure();
+    auto pstruct = pvd::getPVDataCreate()->createPVStructure(type);
+    pvd::shared_vector<double> data(length, 1.0);
+    pstruct->getSubFieldT<pvd::PVDoubleArray>("value")->replace(pvd::freeze(data));
+    return pstruct;
+}
+
+pvd::PVStructurePtr make_enum() {
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->addNestedStructure("value")
+                    ->add("index", pvd::pvInt)
+                    ->addArray("choices", pvd::pvString)
+                    ->endNested()
+                    ->createStructure();
+    auto pstruct = pvd::getPVDataCreate()->createPVStructure(type);
+    pvd::shared_vector<std::string> choices;
+    for (const char* c : {"Stop", "Pause", "Move", "Go (and keep going)"}) {
+        choices.push_back(c);
+    }
+    pstruct->getSubFieldT<pvd::PVStringArray>("value.choices")->replace(pvd::freeze(choices));
+    return pstruct;
+}
+
+// Copy of the previous update_monitored_variable for the types used here
+void legacy_update(std::unordered_map<std::type_index, pvtui::MonitorVar>& slots,
+                   const pvd::PVStructure* pstruct) {
+    std::unordered_map<std::type_index, pvtui::MonitorVar> slots_copy;
+    for (auto& [type_id, data] : slots) {
+        slots_copy.emplace(type_id, data);
+    }
+    for (auto& [type_id, incoming] : slots_copy) {
+        if (auto* d = std::get_if<double>(&incoming)) {
+            *d = pstruct->getSubField<pvd::PVScalar>("value")->getAs<double>();
+        } else if (auto* s = std::get_if<std::string>(&incoming)) {
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(3);
+            pstruct->getSubField("value")->dumpValue(oss);
+            *s = oss.str();
+        } else if (auto* v = std::get_if<std::vector<double>>(&incoming)) {
+            auto vec = pstruct->getSubField<pvd::PVDoubleArray>("value")->view();
+            v->assign(vec.begin(), vec.end());
+        } else if (auto* e = std::get_if<pvtui::PVEnum>(&incoming)) {
+            auto choices = pstruct->getSubField<pvd::PVStringArray>("value.choices")->view();
+            // the old PVEnum held its own copy of the labels and of the selected label,
+            // which were copied on every event
+            e->index = pstruct->getSubField<pvd::PVInt>("value.index")->get();
+            std::vector<std::string> labels(choices.begin(), choices.end());
+            std::string choice = labels.at(e->index);
+        }
+    }
+    for (auto& [type_id, incoming] : slots_copy) {
+        slots[type_id] = std::move(incoming);
+    }
+}
+
+template <typename Update, typename Mutate>
+void run(const std::string& label, Update&& update, Mutate&& mutate) {
+    // warm up so buffers reach their steady-state capacity
+    for (int i = 0; i < 10; i++) {
+        mutate(i);
+        update();
+    }
+
+    size_t allocs = 0;
+    std::chrono::nanoseconds elapsed{0};
+    for (int i = 0; i < N_EVENTS; i++) {
+        mutate(i);
+        const size_t a0 = g_allocs.load(std::memory_order_relaxed);
+        const auto t0 = std::chrono::steady_clock::now();
+        update();
+        elapsed += std::chrono::steady_clock::now() - t0;
+        allocs += g_allocs.load(std::memory_order_relaxed) - a0;
+    }
+
+    std::cout << std::left << std::setw(28) << label << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << static_cast<double>(allocs) / N_EVENTS << " allocs/event" << std::setw(12)
+              << static_cast<double>(elapsed.count()) / N_EVENTS << " ns/event\n";
+}
+
+template <typename... Ts>
+void bench_legacy(const std::string& name, const pvd::PVStructurePtr& pstruct,
+                  const std::function<void(int)>& mutate) {
+    // legacy: one map of variants, copied out and back on every event
+    std::unordered_map<std::type_index, pvtui::MonitorVar> legacy_slots;
+    (legacy_slots.emplace(std::type_index(typeid(Ts)), Ts{}), ...);
+    run(name + " (legacy)", [&] { legacy_update(legacy_slots, pstruct.get()); }, mutate);
+}
+
+template <typename... Ts>
+void bench_current(const std::string& name, const pvd::PVStructurePtr& pstruct,
+                   const std::function<void(int)>& mutate) {
+    // current: in-place update followed by sync into user variables, with the
+    // metadata parsed once as PVHandler does on connect
+    pvtui::PVMetadata metadata;
+    metadata.update(*pstruct);
+    pvtui::MonitorSlots slots;
+    std::tuple<Ts...> user_vars;
+    std::apply([&](auto&... vars) { (slots.add(vars), ...); }, user_vars);
+    run(
+        name + " (current)",
+        [&] {
+            slots.update(pstruct, metadata);
+            slots.sync();
+        },
+        mutate);
+}
+
+template <typename... Ts>
+void bench_case(const std::string& name, const pvd::PVStructurePtr& pstruct,
+                const std::function<void(int)>& mutate) {
+    bench_legacy<Ts...>(name, pstruct, mutate);
+    bench_current<Ts...>(name, pstruct, mutate);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "[pvtui::MonitorSlots] " << N_EVENTS << " events per case\n";
+
+    auto scalar = make_scalar();
+    auto scalar_val = scalar->getSubFieldT<pvd::PVDouble>("value");
+    bench_case<double, std::string>("double + string", scalar, [&](int i) { scalar_val->put(i * 0.125); });
+
+    // std::vector slots copy the array twice per event, ArrayView slots share the
+    // monitor's buffer
+    for (size_t length : {size_t(1440), size_t(100000)}) {
+        auto waveform = make_waveform(length);
+        const std::string name = "waveform[" + std::to_string(length) + "]";
+        bench_case<std::vector<double>>(name, waveform, [](int) {});
+        bench_current<pvtui::ArrayView<double>>(name + " view", waveform, [](int) {});
+    }
+
+    auto penum = make_enum();
+    auto index = penum->getSubFieldT<pvd::PVInt>("value.index");
+    bench_case<pvtui::PVEnum>("enum", penum, [&](int i) { index->put(i % 4); });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,159 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <epicsEndian.h>
+#include <epicsTypes.h>
+#include <pv/createRequest.h>
+#include <pv/pvData.h>
+#include <pv/serialize.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+
+// Measures the bytes a pvAccess monitor puts on the wire per update for the
+// pvRequest a PVHandler uses versus the default request, which subscribes to the
+// whole NTScalar. The server posts value, alarm and timeStamp on every update,
+// like an IOC record processing, and the size of each update is computed by
+// serializing the changed bitset and the changed fields the client received.
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+constexpr int N_UPDATES = 10000;
+
+pvd::PVStructurePtr make_ntscalar() {
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTScalar:1.0")
+                    ->add("value", pvd::pvDouble)
+                    ->addNestedStructure("alarm")
+                    ->add("severity", pvd::pvInt)
+                    ->add("status", pvd::pvInt)
+                    ->add("message", pvd::pvString)
+                    ->endNested()
+                    ->addNestedStructure("timeStamp")
+                    ->add("secondsPastEpoch", pvd::pvLong)
+                    ->add("nanoseconds", pvd::pvInt)
+                    ->add("userTag", pvd::pvInt)
+                    ->endNested()
+                    ->addNestedStructure("display")
+                    ->add("limitLow", pvd::pvDouble)
+                    ->add("limitHigh", pvd::pvDouble)
+                    ->add("description", pvd::pvString)
+                    ->add("units", pvd::pvString)
+                    ->add("precision", pvd::pvInt)
+                    ->add("format", pvd::pvString)
+                    ->endNested()
+                    ->addNestedStructure("control")
+                    ->add("limitLow", pvd::pvDouble)
+                    ->add("limitHigh", pvd::pvDouble)
+                    ->add("minStep", pvd::pvDouble)
+                    ->endNested()
+                    ->createStructure();
+    auto pstruct = pvd::getPVDataCreate()->createPVStructure(type);
+    pstruct->getSubFieldT<pvd::PVString>("display.description")->put("Motor readback position");
+    pstruct->getSubFieldT<pvd::PVString>("display.units")->put("mm");
+    pstruct->getSubFieldT<pvd::PVString>("display.format")->put("F8.4");
+    pstruct->getSubFieldT<pvd::PVDouble>("display.limitLow")->put(-100.0);
+    pstruct->getSubFieldT<pvd::PVDouble>("display.limitHigh")->put(100.0);
+    return pstruct;
+}
+
+// The body of a monitor update: the changed bitset followed by the changed fields
+class ChangedFields : public pvd::Serializable {
+  public:
+    ChangedFields(const pvd::PVStructure& root, const pvd::BitSet& changed)
+        : root_(root), changed_(changed) {}
+
+    void serialize(pvd::ByteBuffer* buffer, pvd::SerializableControl* control) const override {
+        changed_.serialize(buffer, control);
+        root_.serialize(buffer, control, &changed_);
+    }
+
+    void deserialize(pvd::ByteBuffer*, pvd::DeserializableControl*) override {
+        throw std::logic_error("ChangedFields is write only");
+    }
+
+  private:
+    const pvd::PVStructure& root_;
+    mutable pvd::BitSet changed_;
+};
+
+size_t update_size(const pvac::Monitor& mon) {
+    std::vector<epicsUInt8> buf;
+    ChangedFields body(*mon.root, mon.changed);
+    pvd::serializeToVector(&body, EPICS_BYTE_ORDER, buf);
+    return buf.size();
+}
+
+struct NullCallback : public pvac::ClientChannel::MonitorCallback {
+    void monitorEvent(const pvac::MonitorEvent&) override {}
+};
+
+// Polls until an update arrives, returning its size on the wire
+size_t next_update(pvac::Monitor& mon) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!mon.poll()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            throw std::runtime_error("Timed out waiting for monitor update");
+        }
+        std::this_thread::yield();
+    }
+    return update_size(mon);
+}
+
+void bench_request(const std::string& label, const std::string& request) {
+    auto value = make_ntscalar();
+    auto pval = value->getSubFieldT<pvd::PVDouble>("value");
+    auto seconds = value->getSubFieldT<pvd::PVLong>("timeStamp.secondsPastEpoch");
+    auto nanos = value->getSubFieldT<pvd::PVInt>("timeStamp.nanoseconds");
+
+    auto shared_pv = pvas::SharedPV::buildReadOnly();
+    shared_pv->open(*value);
+    pvas::StaticProvider server("pvtui_bench");
+    server.add("pvtui:bench:rbv", shared_pv);
+
+    pvac::ClientProvider provider(server.provider());
+    pvac::ClientChannel channel = provider.connect("pvtui:bench:rbv");
+    NullCallback cb;
+    pvac::Monitor mon =
+        request.empty() ? channel.monitor(&cb) : channel.monitor(&cb, pvd::createRequest(request));
+
+    const size_t initial = next_update(mon);
+
+    pvd::BitSet changed;
+    changed.set(pval->getFieldOffset());
+    changed.set(value->getSubFieldT<pvd::PVStructure>("alarm")->getFieldOffset());
+    changed.set(value->getSubFieldT<pvd::PVStructure>("timeStamp")->getFieldOffset());
+
+    size_t total = 0;
+    for (int i = 0; i < N_UPDATES; i++) {
+        pval->put(i * 0.001);
+        seconds->put(1700000000 + i / 10);
+        nanos->put((i % 10) * 100000000);
+        shared_pv->post(*value, changed);
+        total += next_update(mon);
+    }
+    mon.cancel();
+
+    std::cout << std::left << std::setw(34) << label << std::right << std::setw(10) << initial
+              << " B initial" << std::fixed << std::setprecision(1) << std::setw(10)
+              << static_cast<double>(total) / N_UPDATES << " B/update\n";
+}
+
+} // namespace
+
+int main() {
+    std::cout << "[pvtui::PVHandler] pvRequest size per update, " << N_UPDATES << " updates\n";
+    bench_request("default (whole structure)", "");
+    bench_request("field(value,display) [string]", "field(value,display)");
+    bench_request("field(value) [numeric, enum]", "field(value)");
+    return EXIT_SUCCESS;
+}
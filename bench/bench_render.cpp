@@ -0,0 +1,142 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <pv/pvData.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pvtui/pvtui.hpp>
+
+// Measures the time to build one frame's element tree for a screen the size of
+// apps/asyn.cpp, 30 readbacks on an in-process server. The "legacy" frames rebuild
+// every text and decorator as the renderers did before WidgetBase::cached(), the
+// "cached" frames only rebuild widgets whose PV changed. Each is timed with no PV
+// changed since the last frame and with one PV changed per frame, and once more
+// including the layout and draw into a Screen.
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+constexpr int N_WIDGETS = 30;
+constexpr int N_FRAMES = 2000;
+
+using Widgets = std::vector<std::unique_ptr<pvtui::Monitor<double>>>;
+
+// Readback style as EPICSColor::readback() built it on every call
+ftxui::Decorator legacy_readback(const pvtui::WidgetBase& w) {
+    return pvtui::EPICSColor::custom(
+        w, ftxui::bgcolor(ftxui::Color::RGB(196, 196, 196)) | ftxui::color(ftxui::Color::DarkBlue));
+}
+
+ftxui::Element legacy_frame(const Widgets& widgets) {
+    ftxui::Elements rows;
+    for (const auto& w : widgets) {
+        rows.push_back(ftxui::hbox({
+            ftxui::text(w->pv_name() + ": ") | ftxui::color(ftxui::Color::Black),
+            ftxui::text(std::to_string(w->value())) | legacy_readback(*w) | ftxui::xflex,
+        }));
+    }
+    return ftxui::vbox(std::move(rows));
+}
+
+ftxui::Element cached_frame(const Widgets& widgets) {
+    ftxui::Elements rows;
+    for (const auto& w : widgets) {
+        rows.push_back(ftxui::hbox({
+            ftxui::text(w->pv_name() + ": ") | ftxui::color(ftxui::Color::Black),
+            w->cached([&w] {
+                return ftxui::text(std::to_string(w->value())) | pvtui::EPICSColor::readback(*w);
+            }) | ftxui::xflex,
+        }));
+    }
+    return ftxui::vbox(std::move(rows));
+}
+
+struct Server {
+    pvd::PVStructurePtr value;
+    pvd::BitSet changed;
+    std::vector<pvas::SharedPV::shared_pointer> pvs;
+};
+
+// Changes PV i and syncs until its widget has the new value
+void change(Server& server, pvtui::PVGroup& pvgroup, const Widgets& widgets, int i, double v) {
+    server.value->getSubFieldT<pvd::PVDouble>("value")->put(v);
+    server.pvs[i]->post(*server.value, server.changed);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (widgets[i]->value() != v) {
+        pvgroup.wait_for_data(std::chrono::milliseconds(100));
+        pvgroup.sync();
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cerr << "Timed out waiting for " << widgets[i]->pv_name() << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+}
+
+template <typename Frame>
+void run(const std::string& label, Server& server, pvtui::PVGroup& pvgroup, const Widgets& widgets,
+         Frame frame, bool change_one, bool draw) {
+    auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(80), ftxui::Dimension::Fixed(N_WIDGETS));
+    std::chrono::nanoseconds elapsed{0};
+    for (int f = 0; f < N_FRAMES; f++) {
+        if (change_one) {
+            change(server, pvgroup, widgets, f % N_WIDGETS, f);
+        }
+        const auto t0 = std::chrono::steady_clock::now();
+        ftxui::Element element = frame(widgets);
+        if (draw) {
+            ftxui::Render(screen, element);
+        }
+        elapsed += std::chrono::steady_clock::now() - t0;
+    }
+    std::cout << std::left << std::setw(36) << label << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << static_cast<double>(elapsed.count()) / N_FRAMES / 1000.0 << " us/frame\n";
+}
+
+} // namespace
+
+int main() {
+    Server server;
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTScalar:1.0")
+                    ->add("value", pvd::pvDouble)
+                    ->createStructure();
+    server.value = pvd::getPVDataCreate()->createPVStructure(type);
+    server.changed.set(server.value->getSubFieldT<pvd::PVDouble>("value")->getFieldOffset());
+
+    pvas::StaticProvider provider_server("pvtui_bench_render");
+    std::vector<std::string> names;
+    for (int i = 0; i < N_WIDGETS; i++) {
+        names.push_back("pvtui:bench:render" + std::to_string(i));
+        server.pvs.push_back(pvas::SharedPV::buildReadOnly());
+        server.pvs.back()->open(*server.value);
+        provider_server.add(names.back(), server.pvs.back());
+    }
+
+    pvac::ClientProvider provider(provider_server.provider());
+    pvtui::PVGroup pvgroup(provider);
+    Widgets widgets;
+    for (const std::string& name : names) {
+        widgets.push_back(std::make_unique<pvtui::Monitor<double>>(pvgroup, name));
+    }
+    for (int i = 0; i < N_WIDGETS; i++) {
+        change(server, pvgroup, widgets, i, -1.0);
+    }
+
+    std::cout << "[pvtui::WidgetBase] Frame build time for " << N_WIDGETS << " readbacks\n";
+    run("legacy, no change", server, pvgroup, widgets, legacy_frame, false, false);
+    run("cached, no change", server, pvgroup, widgets, cached_frame, false, false);
+    run("legacy, 1 PV changed", server, pvgroup, widgets, legacy_frame, true, false);
+    run("cached, 1 PV changed", server, pvgroup, widgets, cached_frame, true, false);
+    run("legacy, 1 PV changed + draw", server, pvgroup, widgets, legacy_frame, true, true);
+    run("cached, 1 PV changed + draw", server, pvgroup, widgets, cached_frame, true, true);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <pv/pvData.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pvtui/pvtui.hpp>
+
+// Measures the cost of copying monitored values to subscribed variables with
+// 10k subscribers. The first cases time MonitorSlots::sync() against a replica of
+// the previous per-subscriber std::function dispatch. The last case times
+// PVGroup::sync() for 100 PVs on an in-process server with 100 subscribers each.
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+constexpr int N_SUBSCRIBERS = 10000;
+constexpr int N_PVS = 100;
+constexpr int N_ROUNDS = 1000;
+
+void report(const std::string& label, std::chrono::nanoseconds elapsed, size_t n_syncs) {
+    const double per_sync = static_cast<double>(elapsed.count()) / n_syncs;
+    std::cout << std::left << std::setw(32) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << per_sync << " ns/sync" << std::setw(10) << std::setprecision(3)
+              << per_sync / N_SUBSCRIBERS << " ns/subscriber\n";
+}
+
+pvd::PVStructurePtr make_scalar() {
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTScalar:1.0")
+                    ->add("value", pvd::pvDouble)
+                    ->createStructure();
+    return pvd::getPVDataCreate()->createPVStructure(type);
+}
+
+// Copy of the previous sync(), with one std::function per subscriber
+void bench_legacy_slots() {
+    std::vector<double> vars(N_SUBSCRIBERS);
+    std::vector<std::function<void(const pvtui::MonitorVar&)>> tasks;
+    for (double& var : vars) {
+        tasks.push_back([&var](const pvtui::MonitorVar& latest_data) {
+            if (auto* val = std::get_if<double>(&latest_data)) {
+                var = *val;
+            }
+        });
+    }
+    pvtui::MonitorVar slot = 0.0;
+    std::chrono::nanoseconds elapsed{0};
+    for (int i = 0; i < N_ROUNDS; i++) {
+        slot = static_cast<double>(i);
+        const auto t0 = std::chrono::steady_clock::now();
+        for (auto& task : tasks) {
+            task(slot);
+        }
+        elapsed += std::chrono::steady_clock::now() - t0;
+    }
+    report("MonitorSlots (legacy)", elapsed, N_ROUNDS);
+}
+
+void bench_slots() {
+    auto pstruct = make_scalar();
+    auto pval = pstruct->getSubFieldT<pvd::PVDouble>("value");
+    pvtui::PVMetadata metadata;
+
+    std::vector<double> vars(N_SUBSCRIBERS);
+    pvtui::MonitorSlots slots;
+    for (double& var : vars) {
+        slots.add(var);
+    }
+    std::chrono::nanoseconds elapsed{0};
+    for (int i = 0; i < N_ROUNDS; i++) {
+        pval->put(i);
+        slots.update(pstruct, metadata);
+        const auto t0 = std::chrono::steady_clock::now();
+        slots.sync();
+        elapsed += std::chrono::steady_clock::now() - t0;
+    }
+    if (vars.back() != N_ROUNDS - 1) {
+        std::cerr << "MonitorSlots did not deliver the last value\n";
+        std::exit(EXIT_FAILURE);
+    }
+    report("MonitorSlots (current)", elapsed, N_ROUNDS);
+}
+
+void bench_pvgroup() {
+    auto value = make_scalar();
+    auto pval = value->getSubFieldT<pvd::PVDouble>("value");
+    pvd::BitSet changed;
+    changed.set(pval->getFieldOffset());
+
+    pvas::StaticProvider server("pvtui_bench_sync");
+    std::vector<std::string> names;
+    std::vector<pvas::SharedPV::shared_pointer> shared_pvs;
+    for (int i = 0; i < N_PVS; i++) {
+        names.push_back("pvtui:bench:sync" + std::to_string(i));
+        shared_pvs.push_back(pvas::SharedPV::buildReadOnly());
+        shared_pvs.back()->open(*value);
+        server.add(names.back(), shared_pvs.back());
+    }
+
+    pvac::ClientProvider provider(server.provider());
+    pvtui::PVGroup pvgroup(provider, names);
+    constexpr int PER_PV = N_SUBSCRIBERS / N_PVS;
+    std::vector<double> vars(N_SUBSCRIBERS, -1.0);
+    for (int i = 0; i < N_SUBSCRIBERS; i++) {
+        pvgroup.set_monitor(names[i / PER_PV], vars[i]);
+    }
+
+    // Every PV has delivered round once the last subscriber of each has it
+    auto all_have = [&](double round) {
+        for (int p = 0; p < N_PVS; p++) {
+            if (vars[(p + 1) * PER_PV - 1] != round) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::chrono::nanoseconds elapsed{0};
+    size_t n_syncs = 0;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(120);
+    for (int round = 0; round < N_ROUNDS / 10; round++) {
+        pval->put(round);
+        for (auto& shared_pv : shared_pvs) {
+            shared_pv->post(*value, changed);
+        }
+        while (!all_have(round)) {
+            pvgroup.wait_for_data(std::chrono::milliseconds(100));
+            const auto t0 = std::chrono::steady_clock::now();
+            const bool updated = pvgroup.sync();
+            elapsed += std::chrono::steady_clock::now() - t0;
+            n_syncs += updated;
+            if (std::chrono::steady_clock::now() > deadline) {
+                std::cerr << "Timed out waiting for round " << round << "\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+    }
+    // a round may take several sync() calls if PVs deliver at different times, so
+    // the time reported is the total for delivering every subscriber once
+    std::cout << "  " << N_ROUNDS / 10 << " rounds took " << n_syncs << " updating syncs\n";
+    report("PVGroup (100 PVs x 100)", elapsed, N_ROUNDS / 10);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "[pvtui::PVGroup] sync() with " << N_SUBSCRIBERS << " subscribers\n";
+    bench_legacy_slots();
+    bench_slots();
+    bench_pvgroup();
+    return EXIT_SUCCESS;
+}
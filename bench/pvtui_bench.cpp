@@ -0,0 +1,455 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <pv/configuration.h>
+#include <pv/pvData.h>
+#include <pv/serverContext.h>
+#include <pv/standardField.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pvtui/detail/argh.h>
+#include <pvtui/pvtui.hpp>
+
+// End-to-end benchmark of a pvtui screen against synthetic PVs. An in-process
+// pvAccess server posts N PVs at a fixed rate each, either handing updates to the
+// client directly or over TCP on 127.0.0.1 with --loopback. The client side runs
+// the loop App::run would: it waits for data, syncs the PVGroup at most once per
+// frame, and draws the first rows into a headless ftxui::Screen.
+//
+// Every update carries its send time in its value (the first element for arrays),
+// so the latency from post to sync() and from post to the end of the frame drawing
+// it is measured exactly, without comparing clocks.
+
+namespace pvd = epics::pvData;
+namespace pva = epics::pvAccess;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const USAGE = R"(Usage: pvtui_bench [options]
+
+Runs synthetic PVs on an in-process pvAccess server and measures pvtui against them.
+
+  --pvs N        Number of PVs (default 1000)
+  --rate HZ      Updates per second of each PV (default 10)
+  --array N      Elements per update, 0 for a scalar double (default 0)
+  --seconds S    Length of the measurement (default 10)
+  --fps F        Maximum frames per second (default 30)
+  --rows R       Rows of PVs drawn into the screen (default 40)
+  --loopback     Connect over TCP on 127.0.0.1 instead of directly to the server
+)";
+
+struct Options {
+    size_t pvs = 1000;
+    double rate = 10.0;
+    size_t array = 0;
+    double seconds = 10.0;
+    double fps = 30.0;
+    size_t rows = 40;
+    bool loopback = false;
+};
+
+bool parse(const argh::parser& cmdl, Options& opts) {
+    opts.loopback = cmdl["--loopback"];
+    const bool parsed = (cmdl("--pvs", opts.pvs) >> opts.pvs) && (cmdl("--rate", opts.rate) >> opts.rate) &&
+                        (cmdl("--array", opts.array) >> opts.array) &&
+                        (cmdl("--seconds", opts.seconds) >> opts.seconds) &&
+                        (cmdl("--fps", opts.fps) >> opts.fps) && (cmdl("--rows", opts.rows) >> opts.rows);
+    return parsed && opts.pvs > 0 && opts.rate > 0.0 && opts.seconds > 0.0 && opts.fps > 0.0;
+}
+
+std::string pv_name(size_t i) { return "pvtui:bench:" + std::to_string(i); }
+
+// Time since start encoded in a double, exact for over 100 days of nanoseconds
+double stamp(Clock::time_point start) {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    return static_cast<double>(elapsed.count());
+}
+
+Clock::time_point from_stamp(Clock::time_point start, double ns) {
+    return start + std::chrono::nanoseconds(static_cast<int64_t>(ns));
+}
+
+// CPU time used by the whole process or the calling thread
+std::chrono::microseconds cpu_time(int who) {
+    rusage usage{};
+    getrusage(who, &usage);
+    const auto to_us = [](const timeval& tv) {
+        return std::chrono::seconds(tv.tv_sec) + std::chrono::microseconds(tv.tv_usec);
+    };
+    return to_us(usage.ru_utime) + to_us(usage.ru_stime);
+}
+
+// Resident set size in kB, from /proc/self/statm
+long rss_kb() {
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0;
+    long resident = 0;
+    statm >> pages >> resident;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+long peak_rss_kb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+std::string format_ms(std::chrono::nanoseconds d) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3) << static_cast<double>(d.count()) / 1e6;
+    return oss.str();
+}
+
+// Prints percentiles and a histogram with one line per power of two of microseconds
+void print_latency(const std::string& label, const pvtui::LatencyHistogram::Snapshot& snap) {
+    std::cout << "\n" << label << " (ms), " << snap.count << " samples\n";
+    if (snap.count == 0) {
+        return;
+    }
+    const pvtui::DurationStats stats = snap.stats();
+    std::cout << "  mean " << format_ms(stats.mean) << "  p50 " << format_ms(stats.p50) << "  p90 "
+              << format_ms(stats.p90) << "  p99 " << format_ms(stats.p99) << "  p99.9 "
+              << format_ms(snap.percentile(0.999)) << "  max " << format_ms(stats.max) << "\n";
+
+    std::vector<std::pair<uint64_t, uint64_t>> rows; // upper bound in ns, count
+    for (size_t i = 0; i < pvtui::LatencyHistogram::NUM_BUCKETS; i++) {
+        if (snap.counts[i] == 0) {
+            continue;
+        }
+        // merge the buckets of each power of two above 1 us
+        uint64_t bound = 1000;
+        while (bound < pvtui::LatencyHistogram::bucket_max(i)) {
+            bound *= 2;
+        }
+        if (rows.empty() || rows.back().first != bound) {
+            rows.emplace_back(bound, 0);
+        }
+        rows.back().second += snap.counts[i];
+    }
+    const uint64_t most = std::max_element(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+                              return a.second < b.second;
+                          })->second;
+    for (const auto& [bound, count] : rows) {
+        const size_t bar = static_cast<size_t>(50 * count / most);
+        std::cout << "  <= " << std::setw(10) << format_ms(std::chrono::nanoseconds(bound)) << " "
+                  << std::setw(10) << count << " " << std::string(std::max<size_t>(bar, 1), '#') << "\n";
+    }
+}
+
+class Server {
+  public:
+    Server(const Options& opts, Clock::time_point start)
+        : opts_(opts), start_(start), provider_("pvtui_bench") {
+        auto builder = pvd::getFieldCreate()->createFieldBuilder();
+        if (opts.array > 0) {
+            builder->setId("epics:nt/NTScalarArray:1.0")->addArray("value", pvd::pvDouble);
+        } else {
+            builder->setId("epics:nt/NTScalar:1.0")->add("value", pvd::pvDouble);
+        }
+        value_ = pvd::getPVDataCreate()->createPVStructure(
+            builder->add("timeStamp", pvd::getStandardField()->timeStamp())->createStructure());
+        changed_.set(value_->getSubFieldT<pvd::PVField>("value")->getFieldOffset());
+        changed_.set(value_->getSubFieldT<pvd::PVField>("timeStamp")->getFieldOffset());
+
+        for (size_t i = 0; i < opts.pvs; i++) {
+            pvs_.push_back(pvas::SharedPV::buildReadOnly());
+            pvs_.back()->open(*value_);
+            provider_.add(pv_name(i), pvs_.back());
+        }
+        if (opts.loopback) {
+            // random ports on 127.0.0.1 only, so nothing is broadcast to the network
+            auto config = pva::ConfigurationBuilder()
+                              .add("EPICS_PVAS_INTF_ADDR_LIST", "127.0.0.1")
+                              .add("EPICS_PVA_ADDR_LIST", "127.0.0.1")
+                              .add("EPICS_PVA_AUTO_ADDR_LIST", "NO")
+                              .add("EPICS_PVA_SERVER_PORT", "0")
+                              .add("EPICS_PVA_BROADCAST_PORT", "0")
+                              .push_map()
+                              .build();
+            context_ = pva::ServerContext::create(
+                pva::ServerContext::Config().provider(provider_.provider()).config(config));
+        }
+    }
+
+    ~Server() { this->stop(); }
+
+    /// @brief Makes a client provider connected to the server
+    pvac::ClientProvider client() const {
+        if (context_) {
+            return pvac::ClientProvider("pva", context_->getCurrentConfig());
+        }
+        return pvac::ClientProvider(provider_.provider());
+    }
+
+    /// @brief Posts one update to every PV so that each has a current value
+    void post_all() {
+        for (size_t i = 0; i < pvs_.size(); i++) {
+            this->post(i);
+        }
+    }
+
+    void start() {
+        publisher_ = std::thread([this] { this->run(); });
+    }
+
+    void stop() {
+        stop_.store(true);
+        if (publisher_.joinable()) {
+            publisher_.join();
+        }
+    }
+
+    uint64_t posted() const { return posted_.load(); }
+
+    std::chrono::microseconds cpu() const { return cpu_; }
+
+  private:
+    void post(size_t i) {
+        const double now = stamp(start_);
+        if (opts_.array > 0) {
+            pvd::shared_vector<double> data(opts_.array, 0.0);
+            data[0] = now;
+            value_->getSubFieldT<pvd::PVDoubleArray>("value")->replace(pvd::freeze(data));
+        } else {
+            value_->getSubFieldT<pvd::PVDouble>("value")->put(now);
+        }
+        const auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+        const auto secs = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+        value_->getSubFieldT<pvd::PVLong>("timeStamp.secondsPastEpoch")->put(secs.count());
+        value_->getSubFieldT<pvd::PVInt>("timeStamp.nanoseconds")
+            ->put(static_cast<pvd::int32>(std::chrono::nanoseconds(since_epoch - secs).count()));
+        pvs_[i]->post(*value_, changed_);
+    }
+
+    // Posts round robin so that every PV updates at the requested rate, catching
+    // up in a burst if a post was late
+    void run() {
+        const auto begin = Clock::now();
+        const double total_rate = opts_.rate * static_cast<double>(opts_.pvs);
+        uint64_t sent = 0;
+        size_t next = 0;
+        while (!stop_.load()) {
+            const double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+            const auto due = static_cast<uint64_t>(elapsed * total_rate);
+            for (; sent < due && !stop_.load(); sent++) {
+                this->post(next);
+                next = (next + 1) % pvs_.size();
+                posted_.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        cpu_ = cpu_time(RUSAGE_THREAD);
+    }
+
+    const Options& opts_;
+    Clock::time_point start_;
+    pvas::StaticProvider provider_;
+    std::vector<pvas::SharedPV::shared_pointer> pvs_;
+    pva::ServerContext::shared_pointer context_;
+    pvd::PVStructurePtr value_;
+    pvd::BitSet changed_;
+    std::thread publisher_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> posted_{0};
+    std::chrono::microseconds cpu_{0};
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    argh::parser cmdl;
+    cmdl.add_params({"--pvs", "--rate", "--array", "--seconds", "--fps", "--rows"});
+    cmdl.parse(argc, argv);
+    Options opts;
+    if (cmdl[{"-h", "--help"}]) {
+        std::cout << USAGE;
+        return EXIT_SUCCESS;
+    }
+    if (!parse(cmdl, opts)) {
+        std::cerr << USAGE;
+        return EXIT_FAILURE;
+    }
+
+    const auto start = Clock::now();
+    const long rss_before = rss_kb();
+    Server server(opts, start);
+    server.post_all();
+
+    pvac::ClientProvider provider = server.client();
+    pvtui::PVGroup pvgroup(provider);
+    std::vector<double> scalars(opts.pvs, -1.0);
+    std::vector<pvtui::ArrayView<double>> arrays(opts.pvs);
+    std::vector<pvtui::Subscription> subscriptions;
+    for (size_t i = 0; i < opts.pvs; i++) {
+        subscriptions.push_back(opts.array > 0 ? pvgroup.subscribe(pv_name(i), arrays[i])
+                                               : pvgroup.subscribe(pv_name(i), scalars[i]));
+        subscriptions.back().set_active(true);
+    }
+    const auto sent_at = [&](size_t i) {
+        if (opts.array > 0) {
+            return arrays[i].empty() ? -1.0 : arrays[i][0];
+        }
+        return scalars[i];
+    };
+
+    // Wait for every PV's first value before measuring
+    const auto connect_deadline = Clock::now() + std::chrono::seconds(60);
+    size_t ready = 0;
+    while (ready < opts.pvs) {
+        if (Clock::now() > connect_deadline) {
+            std::cerr << "Only " << ready << " of " << opts.pvs << " PVs connected\n";
+            return EXIT_FAILURE;
+        }
+        pvgroup.wait_for_data(std::chrono::milliseconds(100));
+        pvgroup.sync();
+        ready = 0;
+        for (size_t i = 0; i < opts.pvs; i++) {
+            ready += sent_at(i) >= 0.0 ? 1 : 0;
+        }
+    }
+    const auto connected = Clock::now();
+    const long rss_connected = rss_kb();
+
+    auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(80),
+                                        ftxui::Dimension::Fixed(static_cast<int>(opts.rows)));
+    const size_t rows = std::min(opts.rows, opts.pvs);
+    std::vector<double> last(opts.pvs);
+    for (size_t i = 0; i < opts.pvs; i++) {
+        last[i] = sent_at(i);
+    }
+
+    pvtui::LatencyHistogram to_sync;
+    pvtui::LatencyHistogram to_paint;
+    pvtui::LatencyHistogram frame_time;
+    uint64_t values_synced = 0;
+    uint64_t frames = 0;
+    size_t bytes = 0;
+    std::vector<double> painted;
+
+    const uint64_t events_before = [&] {
+        uint64_t total = 0;
+        for (const auto& pv : pvgroup.pv_metrics()) {
+            total += pv.monitor_events;
+        }
+        return total;
+    }();
+    const size_t dropped_before = pvgroup.dropped_updates();
+    const auto process_cpu_before = cpu_time(RUSAGE_SELF);
+    const auto ui_cpu_before = cpu_time(RUSAGE_THREAD);
+
+    server.start();
+    const auto begin = Clock::now();
+    const auto seconds = [](double s) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(s));
+    };
+    const auto end = begin + seconds(opts.seconds);
+    const auto frame_interval = seconds(1.0 / opts.fps);
+    auto next_frame = begin;
+
+    // The loop of App::run: sleep until data arrives and the frame slot is due,
+    // then sync and draw once for everything which arrived meanwhile
+    while (Clock::now() < end) {
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(end - Clock::now());
+        pvgroup.wait_for_data(std::max(left, std::chrono::milliseconds(1)));
+        std::this_thread::sleep_until(next_frame);
+        const auto frame_start = Clock::now();
+        if (!pvgroup.sync()) {
+            continue;
+        }
+        const auto synced = Clock::now();
+        painted.clear();
+        for (size_t i = 0; i < opts.pvs; i++) {
+            const double sent = sent_at(i);
+            if (sent == last[i]) {
+                continue;
+            }
+            last[i] = sent;
+            values_synced++;
+            to_sync.record(synced - from_stamp(start, sent));
+            if (i < rows) {
+                painted.push_back(sent);
+            }
+        }
+
+        ftxui::Elements lines;
+        for (size_t i = 0; i < rows; i++) {
+            lines.push_back(ftxui::hbox({
+                ftxui::text(pv_name(i)) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 24),
+                ftxui::text(std::to_string(last[i])),
+            }));
+        }
+        ftxui::Render(screen, ftxui::vbox(std::move(lines)));
+        bytes += screen.ToString().size();
+
+        const auto drawn = Clock::now();
+        frame_time.record(drawn - frame_start);
+        for (double sent : painted) {
+            to_paint.record(drawn - from_stamp(start, sent));
+        }
+        frames++;
+        next_frame = frame_start + frame_interval;
+    }
+    const auto finished = Clock::now();
+    const auto ui_cpu = cpu_time(RUSAGE_THREAD) - ui_cpu_before;
+    server.stop();
+    const auto process_cpu = cpu_time(RUSAGE_SELF) - process_cpu_before;
+
+    uint64_t events = 0;
+    for (const auto& pv : pvgroup.pv_metrics()) {
+        events += pv.monitor_events;
+    }
+    events -= events_before;
+    const double secs = std::chrono::duration<double>(finished - begin).count();
+    const auto per_sec = [secs](double n) { return static_cast<uint64_t>(n / secs); };
+    const auto cores = [secs](std::chrono::microseconds cpu) {
+        return std::chrono::duration<double>(cpu).count() / secs;
+    };
+
+    std::cout << "[pvtui_bench] " << opts.pvs << " PVs at " << opts.rate << " Hz, "
+              << (opts.array > 0 ? std::to_string(opts.array) + " element arrays" : std::string("scalars"))
+              << ", " << (opts.loopback ? "TCP loopback" : "direct") << ", " << std::fixed
+              << std::setprecision(1) << secs << " s\n\n";
+    std::cout << "First values of all PVs after " << format_ms(connected - start) << " ms\n\n";
+
+    std::cout << "Throughput (per second)\n"
+              << "  posted         " << std::setw(12) << per_sec(server.posted()) << "\n"
+              << "  monitor events " << std::setw(12) << per_sec(events) << "\n"
+              << "  dropped        " << std::setw(12) << per_sec(pvgroup.dropped_updates() - dropped_before)
+              << "\n"
+              << "  values synced  " << std::setw(12) << per_sec(values_synced) << "\n"
+              << "  frames         " << std::setw(12) << per_sec(frames) << "\n"
+              << "  screen bytes   " << std::setw(12) << per_sec(bytes) << "\n";
+
+    print_latency("Post to sync()", to_sync.snapshot());
+    print_latency("Post to drawn frame, first " + std::to_string(rows) + " PVs", to_paint.snapshot());
+    print_latency("Frame, sync to drawn", frame_time.snapshot());
+    print_latency("PVGroup::sync()", pvgroup.sync_time().snapshot());
+
+    std::cout << "\nCPU (cores)\n"
+              << std::setprecision(3) << "  process        " << std::setw(12) << cores(process_cpu) << "\n"
+              << "  UI thread      " << std::setw(12) << cores(ui_cpu) << "\n"
+              << "  publisher      " << std::setw(12) << cores(server.cpu()) << "\n";
+    std::cout << "\nMemory (kB)\n"
+              << "  RSS at start   " << std::setw(12) << rss_before << "\n"
+              << "  RSS connected  " << std::setw(12) << rss_connected << "\n"
+              << "  RSS at end     " << std::setw(12) << rss_kb() << "\n"
+              << "  peak RSS       " << std::setw(12) << peak_rss_kb() << "\n";
+    return EXIT_SUCCESS;
+}
@@ -1,10 +1,15 @@
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <iomanip>
+#include <optional>
 #include <sstream>
 #include <thread>
 
+#include <ftxui/component/component.hpp>
 #include <ftxui/component/event.hpp>
 #include <ftxui/component/loop.hpp>
+#include <ftxui/dom/elements.hpp>
 
 #include <pvtui/app.hpp>
 
@@ -13,9 +18,16 @@ namespace pvtui {
 ArgParser::ArgParser(int argc, char* argv[]) {
     cmdl_.add_params({"-m", "--macro", "--macros"});
     cmdl_.add_params({"--provider"});
+    cmdl_.add_params({"--max-fps"});
+    cmdl_.add_params({"--trace"});
     cmdl_.parse(argc, argv);
     this->macros = get_macro_dict(cmdl_({"-m", "--macro", "--macros"}).str());
     this->provider = cmdl_("--provider").str().empty() ? "ca" : cmdl_("--provider").str();
+    if (!(cmdl_("--max-fps", 0.0) >> this->max_fps) || this->max_fps < 0.0) {
+        this->max_fps = 0.0;
+    }
+    this->trace_latency = cmdl_["trace-latency"];
+    this->trace_file = cmdl_("--trace").str();
 }
 
 bool ArgParser::macros_present(const std::vector<std::string>& macro_list) const {
@@ -67,6 +79,208 @@ std::unordered_map<std::string, std::string> ArgParser::get_macro_dict(std::stri
     return map_out;
 }
 
+RenderScheduler::RenderScheduler(const RenderOptions& options) : options_(options) {}
+
+bool RenderScheduler::wait_for_slot() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !pending_ || stopped_; });
+    cv_.wait_until(lock, last_start_ + interval_locked(), [this] { return stopped_; });
+    if (stopped_) {
+        return false;
+    }
+    pending_ = true;
+    started_ = false;
+    return true;
+}
+
+void RenderScheduler::frame_started() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    last_start_ = clock::now();
+    started_ = true;
+}
+
+void RenderScheduler::frame_finished() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (!started_) {
+            return;
+        }
+        // exponential moving average with weight 1/4 on the newest frame
+        const auto elapsed = clock::now() - last_start_;
+        render_avg_ += (elapsed - render_avg_) / 4;
+        pending_ = false;
+        started_ = false;
+    }
+    cv_.notify_all();
+}
+
+void RenderScheduler::stop() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    cv_.notify_all();
+}
+
+RenderScheduler::clock::duration RenderScheduler::interval() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return interval_locked();
+}
+
+RenderScheduler::clock::duration RenderScheduler::render_duration() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return render_avg_;
+}
+
+RenderScheduler::clock::duration RenderScheduler::interval_locked() const {
+    using seconds = std::chrono::duration<double>;
+    auto interval = options_.max_fps > 0.0 ? std::chrono::duration_cast<clock::duration>(
+                                                 seconds(1.0 / options_.max_fps))
+                                           : clock::duration::zero();
+    // back off so that rendering takes at most max_render_load of the time
+    if (options_.max_render_load > 0.0) {
+        const auto load_limited =
+            std::chrono::duration_cast<clock::duration>(render_avg_ / options_.max_render_load);
+        interval = std::max(interval, load_limited);
+    }
+    if (options_.min_fps > 0.0) {
+        interval = std::min(interval,
+                            std::chrono::duration_cast<clock::duration>(seconds(1.0 / options_.min_fps)));
+    }
+    return interval;
+}
+
+namespace {
+
+/// @brief Minimum length of the window App::metrics() computes rates over.
+constexpr auto METRICS_WINDOW = std::chrono::seconds(1);
+
+/// @brief Number of busiest PVs listed in the metrics overlay.
+constexpr size_t HUD_PVS = 5;
+
+std::string format_duration(std::chrono::nanoseconds d) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    if (d < std::chrono::microseconds(1000)) {
+        oss << static_cast<double>(d.count()) / 1e3 << " us";
+    } else if (d < std::chrono::milliseconds(1000)) {
+        oss << static_cast<double>(d.count()) / 1e6 << " ms";
+    } else {
+        oss << static_cast<double>(d.count()) / 1e9 << " s";
+    }
+    return oss.str();
+}
+
+std::string format_rate(double rate) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1) << rate;
+    return oss.str();
+}
+
+std::string format_stats(const DurationStats& stats) {
+    if (stats.count == 0) {
+        return "-";
+    }
+    return "mean " + format_duration(stats.mean) + "  p50 " + format_duration(stats.p50) + "  p90 " +
+           format_duration(stats.p90) + "  p99 " + format_duration(stats.p99) + "  max " +
+           format_duration(stats.max);
+}
+
+ftxui::Element hud_row(const std::string& label, const std::string& value) {
+    return ftxui::hbox({
+        ftxui::text(label) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 14),
+        ftxui::text(value),
+    });
+}
+
+/// @brief Builds the overlay shown by the default main loop while App::hud_visible is set.
+ftxui::Element metrics_hud(const Metrics& m) {
+    ftxui::Elements rows = {
+        hud_row("PVs", std::to_string(m.connected) + "/" + std::to_string(m.pvs) + " connected"),
+        hud_row("events/s", format_rate(m.events_per_sec) + "  (total " + std::to_string(m.monitor_events) +
+                                ", dropped " + std::to_string(m.dropped_updates) + ", errors " +
+                                std::to_string(m.conversion_errors) + ")"),
+        hud_row("sync", format_stats(m.sync)),
+        hud_row("dirty PVs", std::to_string(m.last_sync_pvs) + " at last sync"),
+        hud_row("frame build", format_stats(m.frame_build)),
+        hud_row("frame", format_stats(m.frame)),
+        hud_row("fps", format_rate(m.frames_per_sec)),
+        hud_row("puts", std::to_string(m.puts_pending) + " pending, " + std::to_string(m.puts_coalesced) +
+                            " coalesced"),
+        hud_row("put latency", format_stats(m.put_latency)),
+    };
+    const bool tracing = std::any_of(m.per_pv.begin(), m.per_pv.end(), [](const PVMetrics& pv) {
+        return pv.latency != nullptr;
+    });
+    if (tracing) {
+        rows.push_back(ftxui::separator());
+        rows.push_back(hud_row("network", format_stats(m.source_to_callback)));
+        rows.push_back(hud_row("queued", format_stats(m.callback_to_sync)));
+        rows.push_back(hud_row("paint", format_stats(m.sync_to_paint)));
+        rows.push_back(hud_row("end to end", format_stats(m.source_to_paint)));
+    }
+
+    std::vector<const PVMetrics*> busiest;
+    for (const PVMetrics& pv : m.per_pv) {
+        busiest.push_back(&pv);
+    }
+    const size_t n = std::min(HUD_PVS, busiest.size());
+    std::partial_sort(busiest.begin(), busiest.begin() + n, busiest.end(), [](const auto* a, const auto* b) {
+        return a->events_per_sec > b->events_per_sec;
+    });
+    if (n > 0) {
+        rows.push_back(ftxui::separator());
+    }
+    for (size_t i = 0; i < n; i++) {
+        std::string name = busiest[i]->name;
+        if (busiest[i]->source_to_paint.count > 0) {
+            name += "  p99 " + format_duration(busiest[i]->source_to_paint.p99);
+        }
+        rows.push_back(hud_row(format_rate(busiest[i]->events_per_sec) + "/s", name));
+    }
+
+    return ftxui::window(ftxui::text(" metrics (" + format_duration(m.window) + " window) "),
+                         ftxui::vbox(std::move(rows))) |
+           ftxui::bgcolor(ftxui::Color::Black) | ftxui::color(ftxui::Color::White) | ftxui::clear_under;
+}
+
+/// @brief Wraps the application's component to time each frame build, and to draw and toggle the overlay.
+ftxui::Component instrument(App& app, const ftxui::Component& renderer) {
+    using clock = std::chrono::steady_clock;
+    auto timed = ftxui::Renderer(renderer, [&app, renderer, overlay = ftxui::Element(),
+                                            overlay_time = clock::time_point()]() mutable {
+        const auto start = clock::now();
+        ftxui::Element element = renderer->Render();
+        app.frame_build_time.record(clock::now() - start);
+        if (!app.hud_visible.load(std::memory_order_relaxed)) {
+            return element;
+        }
+        // metrics() copies every PV and the overlay sorts them, so it is only rebuilt once per window
+        if (!overlay || clock::now() - overlay_time >= METRICS_WINDOW) {
+            overlay = ftxui::vbox({metrics_hud(app.metrics()), ftxui::filler()});
+            overlay_time = clock::now();
+        }
+        return ftxui::dbox({element, ftxui::hbox({ftxui::filler(), overlay})});
+    });
+    return ftxui::CatchEvent(timed, [&app](const ftxui::Event& event) {
+        if (event != app.hud_key) {
+            return false;
+        }
+        app.hud_visible.store(!app.hud_visible.load());
+        // so the waker stops blocking without a timeout
+        app.pvgroup.wake();
+        return true;
+    });
+}
+
+LatencyHistogram::Snapshot difference(LatencyHistogram::Snapshot current,
+                                      const LatencyHistogram::Snapshot& start) {
+    current -= start;
+    return current;
+}
+
+} // namespace
+
 static pvac::ClientProvider init_epics_provider(const std::string& p) {
     epics::pvAccess::ca::CAClientFactory::start();
     pvac::ClientProvider provider(p);
@@ -77,20 +291,140 @@ App::App(int argc, char* argv[])
     : args(argc, argv), provider(init_epics_provider(args.provider)), pvgroup(provider),
       screen(ftxui::ScreenInteractive::Fullscreen()) {
 
+    if (args.max_fps > 0.0) {
+        render_options.max_fps = args.max_fps;
+    }
+    window_start_.time = std::chrono::steady_clock::now();
+    if (!args.trace_file.empty()) {
+        pvgroup.trace_to_file(args.trace_file);
+    } else if (args.trace_latency) {
+        pvgroup.trace_latency();
+    }
+
     main_loop = [](App& app, const ftxui::Component& renderer, int ms) {
-        ftxui::Loop loop(&app.screen, renderer);
+        RenderOptions options = app.render_options;
+        if (ms > 0) {
+            options.max_fps = 1000.0 / ms;
+        }
+        RenderScheduler scheduler(options);
+
+        // A data-driven frame is timed from its sync until RunOnceBlocking returns,
+        // which happens after the frame has been drawn to the terminal. The
+        // latency tracing also ends the updates of the sync there.
+        ftxui::Loop loop(&app.screen, instrument(app, renderer));
+        std::optional<std::chrono::steady_clock::time_point> frame_start;
+
+        // Activates the displays constructed before run(), which don't connect
+        // their PVs until then
+        app.pvgroup.sync();
+
+        // Sleeps until PV data arrives and the scheduler grants a frame, then posts a
+        // sync and redraw to the UI thread. Data arriving meanwhile joins that frame.
+        // While the overlay is shown, it is also redrawn once a second without new data.
+        std::atomic<bool> quit{false};
+        std::thread waker([&app, &quit, &scheduler, &frame_start] {
+            while (true) {
+                bool refresh = false;
+                if (app.hud_visible.load()) {
+                    refresh = !app.pvgroup.wait_for_data(std::chrono::seconds(1));
+                } else {
+                    app.pvgroup.wait_for_data();
+                }
+                if (quit.load() || !scheduler.wait_for_slot()) {
+                    break;
+                }
+                app.screen.Post([&app, &scheduler, &frame_start, refresh] {
+                    scheduler.frame_started();
+                    frame_start = std::chrono::steady_clock::now();
+                    if (app.pvgroup.sync() || refresh) {
+                        app.screen.PostEvent(ftxui::Event::Custom);
+                    }
+                });
+            }
+        });
+
         while (!loop.HasQuitted()) {
-            if (app.pvgroup.sync()) {
-                app.screen.PostEvent(ftxui::Event::Custom);
+            loop.RunOnceBlocking();
+            scheduler.frame_finished();
+            if (frame_start) {
+                app.frame_time.record(std::chrono::steady_clock::now() - *frame_start);
+                app.pvgroup.frame_drawn();
+                frame_start.reset();
             }
-            loop.RunOnce();
-            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
         }
+
+        quit.store(true);
+        scheduler.stop();
+        app.pvgroup.wake();
+        waker.join();
     };
 }
 
-void App::run(const ftxui::Component& renderer, int poll_period_ms) {
-    main_loop(*this, renderer, poll_period_ms);
+void App::run(const ftxui::Component& renderer, int min_frame_ms) { main_loop(*this, renderer, min_frame_ms); }
+
+Metrics App::metrics() {
+    const std::lock_guard<std::mutex> lock(metrics_mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    // the first call closes a window early so that the totals are there from the start
+    if (now - window_start_.time >= METRICS_WINDOW || last_window_.window.count() == 0) {
+        this->close_window(now);
+    }
+
+    Metrics out = last_window_;
+    out.last_sync_pvs = pvgroup.last_sync_pvs();
+    out.puts_pending = pvgroup.put_queue().pending();
+    out.puts_coalesced = pvgroup.put_queue().coalesced();
+    return out;
+}
+
+void App::close_window(std::chrono::steady_clock::time_point now) {
+    const double seconds = std::chrono::duration<double>(now - window_start_.time).count();
+    MetricsSample next;
+    next.time = now;
+    next.sync = pvgroup.sync_time().snapshot();
+    next.frame_build = frame_build_time.snapshot();
+    next.frame = frame_time.snapshot();
+    next.put_latency = pvgroup.put_queue().latency().snapshot();
+    const LatencyStages& stages = pvgroup.latency();
+    next.source_to_callback = stages.source_to_callback.snapshot();
+    next.callback_to_sync = stages.callback_to_sync.snapshot();
+    next.sync_to_paint = stages.sync_to_paint.snapshot();
+    next.source_to_paint = stages.source_to_paint.snapshot();
+
+    Metrics m;
+    m.per_pv = pvgroup.pv_metrics();
+    m.pvs = m.per_pv.size();
+    for (PVMetrics& pv : m.per_pv) {
+        next.events[pv.name] = pv.monitor_events;
+        // a PV added during the window counts from zero
+        auto it = window_start_.events.find(pv.name);
+        const uint64_t before = it != window_start_.events.end() ? it->second : 0;
+        const uint64_t events = pv.monitor_events - std::min(before, pv.monitor_events);
+        pv.events_per_sec = seconds > 0.0 ? static_cast<double>(events) / seconds : 0.0;
+        // a pass over the PV's histogram, which is why this is only done once per window
+        if (pv.latency) {
+            pv.source_to_paint = pv.latency->source_to_paint.snapshot().stats();
+        }
+        m.events_per_sec += pv.events_per_sec;
+        m.monitor_events += pv.monitor_events;
+        m.dropped_updates += pv.dropped_updates;
+        m.conversion_errors += pv.conversion_errors;
+        m.connected += pv.connected ? 1 : 0;
+    }
+
+    m.window = std::chrono::duration_cast<std::chrono::nanoseconds>(now - window_start_.time);
+    m.sync = difference(next.sync, window_start_.sync).stats();
+    m.frame_build = difference(next.frame_build, window_start_.frame_build).stats();
+    m.frame = difference(next.frame, window_start_.frame).stats();
+    m.put_latency = difference(next.put_latency, window_start_.put_latency).stats();
+    m.frames_per_sec = seconds > 0.0 ? static_cast<double>(m.frame_build.count) / seconds : 0.0;
+    const MetricsSample& s = window_start_;
+    m.source_to_callback = difference(next.source_to_callback, s.source_to_callback).stats();
+    m.callback_to_sync = difference(next.callback_to_sync, s.callback_to_sync).stats();
+    m.sync_to_paint = difference(next.sync_to_paint, s.sync_to_paint).stats();
+    m.source_to_paint = difference(next.source_to_paint, s.source_to_paint).stats();
+    window_start_ = std::move(next);
+    last_window_ = std::move(m);
 }
 
 } // namespace pvtui
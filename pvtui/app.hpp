@@ -1,15 +1,21 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include <ftxui/component/component_options.hpp>
+#include <ftxui/component/event.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 
 #include <pvtui/detail/argh.h>
+#include <pvtui/metrics.hpp>
 #include <pvtui/pvgroup.hpp>
 
 namespace pvtui {
@@ -66,6 +72,9 @@ class ArgParser {
 
     std::unordered_map<std::string, std::string> macros; ///< Parsed macros (e.g., "P=VAL").
     std::string provider = "ca";                         ///< The EPICS provider type (e.g., "ca", "pva").
+    double max_fps = 0.0;                                ///< Value of --max-fps, or 0 if not given.
+    bool trace_latency = false;                          ///< Whether --trace-latency was given.
+    std::string trace_file;                              ///< Value of --trace, or empty if not given.
 
   private:
     argh::parser cmdl_; ///< Internal argh parser instance.
@@ -86,6 +95,80 @@ class ArgParser {
     std::unordered_map<std::string, std::string> get_macro_dict(std::string all_macros);
 };
 
+/**
+ * @brief Options controlling how often App redraws in response to PV data.
+ */
+struct RenderOptions {
+    double max_fps = 30.0;        ///< Maximum number of data-driven redraws per second.
+    double min_fps = 1.0;         ///< Lowest redraw rate that back-off may reduce to.
+    double max_render_load = 0.5; ///< Fraction of wall time rendering may use before backing off.
+};
+
+/**
+ * @brief Decides when App may draw the next data-driven frame.
+ *
+ * PV updates arriving while a frame is pending or waiting for its slot are
+ * coalesced into that frame. Frames start at most max_fps times per second,
+ * and when rendering is slow (e.g. a large screen over a congested SSH link) the
+ * interval grows so rendering uses at most max_render_load of wall time.
+ */
+class RenderScheduler {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Constructs a RenderScheduler.
+     * @param options The frame rate limits to apply.
+     */
+    explicit RenderScheduler(const RenderOptions& options);
+
+    /**
+     * @brief Blocks until the previous frame has finished and the frame interval has elapsed.
+     * @return True if a frame may be started, false if stop() was called.
+     */
+    bool wait_for_slot();
+
+    /**
+     * @brief Marks the start of a frame granted by wait_for_slot(). Called from the UI thread.
+     */
+    void frame_started();
+
+    /**
+     * @brief Marks the end of the current frame, if any, and updates the render time estimate.
+     * Called from the UI thread.
+     */
+    void frame_finished();
+
+    /**
+     * @brief Wakes wait_for_slot() and makes it return false from now on.
+     */
+    void stop();
+
+    /**
+     * @brief Gets the current minimum time between frame starts.
+     * @return The frame interval including any back-off.
+     */
+    clock::duration interval() const;
+
+    /**
+     * @brief Gets the smoothed duration of recent frames.
+     * @return The average time from frame_started() to frame_finished().
+     */
+    clock::duration render_duration() const;
+
+  private:
+    clock::duration interval_locked() const;
+
+    RenderOptions options_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool pending_ = false;          ///< A frame was granted and has not finished.
+    bool started_ = false;          ///< The granted frame has started on the UI thread.
+    bool stopped_ = false;          ///< stop() was called.
+    clock::time_point last_start_;  ///< Start time of the most recent frame.
+    clock::duration render_avg_{0}; ///< Smoothed frame duration.
+};
+
 /**
  * @brief Convenience struct for managing a TUI application
  *
@@ -104,18 +187,70 @@ struct App {
 
     /**
      * @brief Runs the main FTXUI loop
+     *
+     * The default loop sleeps until a PV receives new data or a terminal event
+     * arrives, and schedules data-driven redraws according to render_options.
+     * Pressing hud_key shows or hides an overlay with the numbers from metrics().
+     *
+     * The second argument used to be poll_period_ms, defaulting to 100, the sleep
+     * between polls of the old loop. It is now a minimum frame interval, so a caller
+     * passing a poll period caps data-driven redraws at that rate instead, while
+     * terminal events are still handled immediately. The default of 0 uses
+     * render_options.max_fps, 30 frames per second unless changed.
      * @param renderer The ftxui::Component which defines the application layout
-     * @param poll_period_ms Render loop polling period in milliseconds
+     * @param min_frame_ms If positive, overrides render_options.max_fps with a
+     * minimum interval between data-driven redraws in milliseconds
+     */
+    void run(const ftxui::Component& renderer, int min_frame_ms = 0);
+
+    /**
+     * @brief Gets runtime statistics of the application. Safe to call from any thread.
+     *
+     * Everything but the dirty PVs and pending puts is computed when a window of
+     * about one second is closed by the first call after it ends, and covers that
+     * window. Calls in between return a copy of it, which still copies per_pv, so
+     * callers drawing every frame should keep the result for a window like the
+     * default overlay does. The latency stages are only recorded while tracing, see
+     * PVGroup::trace_latency().
+     * @return The current metrics.
      */
-    void run(const ftxui::Component& renderer, int poll_period_ms = 100);
+    Metrics metrics();
 
     /// @brief The main loop function to run with App::run. Can be redefined by the user
     std::function<void(App&, const ftxui::Component&, int)> main_loop;
 
     pvtui::ArgParser args;           ///< pvtui::ArgParser to store the cmd line arguments
+    RenderOptions render_options;    ///< Frame rate limits used by the default main_loop
     pvac::ClientProvider provider;   ///< EPICS client provider
     PVGroup pvgroup;                 ///< pvtui::PVGroup to manage PVs used in the application
     ftxui::ScreenInteractive screen; ///< screen instance for FTXUI rendering
+
+    ftxui::Event hud_key = ftxui::Event::F12; ///< Key which toggles the metrics overlay
+    std::atomic<bool> hud_visible = false;    ///< Whether the metrics overlay is shown
+    LatencyHistogram frame_build_time;        ///< Time to build each frame, recorded by main_loop
+    LatencyHistogram frame_time;              ///< Data-driven frames from sync to draw, recorded by main_loop
+
+  private:
+    /// @brief Counters at the start of a metrics window.
+    struct MetricsSample {
+        std::chrono::steady_clock::time_point time;       ///< When the sample was taken.
+        std::unordered_map<std::string, uint64_t> events; ///< Monitor events of each PV.
+        LatencyHistogram::Snapshot sync;                  ///< PVGroup::sync_time().
+        LatencyHistogram::Snapshot frame_build;           ///< frame_build_time.
+        LatencyHistogram::Snapshot frame;                 ///< frame_time.
+        LatencyHistogram::Snapshot put_latency;           ///< PutQueue::latency().
+        LatencyHistogram::Snapshot source_to_callback;    ///< PVGroup::latency() stages.
+        LatencyHistogram::Snapshot callback_to_sync;      ///< See source_to_callback.
+        LatencyHistogram::Snapshot sync_to_paint;         ///< See source_to_callback.
+        LatencyHistogram::Snapshot source_to_paint;       ///< See source_to_callback.
+    };
+
+    /// @brief Computes last_window_ from the counters since window_start_ and starts a new window.
+    void close_window(std::chrono::steady_clock::time_point now);
+
+    std::mutex metrics_mutex_;   ///< Serializes metrics().
+    MetricsSample window_start_; ///< Start of the current window.
+    Metrics last_window_;        ///< Metrics of the last completed window.
 };
 
 } // namespace pvtui
@@ -1,4 +1,7 @@
 #pragma once
+#include <string>
+#include <vector>
+
 #include <ftxui/component/component_base.hpp>
 #include <pvtui/app.hpp>
 #include <pvtui/pvgroup.hpp>
@@ -9,6 +12,14 @@ namespace pvtui {
  * @brief Base class for PVTUI displays
  *
  * Provides common functionality for managing a group of PVs and rendering a UI.
+ *
+ * The PVs of widgets constructed along with the display belong to it, and are
+ * connected and monitored only while the display is active. Derived classes call
+ * end_construction() at the end of their constructor, so that widgets created
+ * afterwards don't belong to the display. A display is active
+ * unless deactivate() is called before the first PVGroup::sync(), so displays
+ * which are not shown at startup, such as hidden tabs, never connect their PVs
+ * until activate() is called.
  */
 class DisplayBase {
   public:
@@ -16,18 +27,48 @@ class DisplayBase {
      * @brief Constructs a DisplayBase object.
      * @param pvgroup A reference to the PVGroup managing the PVs for this display.
      */
-    DisplayBase(pvtui::PVGroup& pvgroup) : pvgroup(pvgroup) {}
+    DisplayBase(pvtui::PVGroup& pvgroup) : pvgroup(pvgroup) { pvgroup.begin_capture(subscriptions_); }
+
+    /**
+     * @brief Constructs a DisplayBase object, adding the PVs of its widgets in one batch.
+     *
+     * Faster than letting each widget add its PV when the display has many of them.
+     * @param pvgroup A reference to the PVGroup managing the PVs for this display.
+     * @param pv_names The expanded names of the PVs the display's widgets will use.
+     */
+    DisplayBase(pvtui::PVGroup& pvgroup, const std::vector<std::string>& pv_names) : DisplayBase(pvgroup) {
+        pvgroup.prepare(pv_names);
+    }
 
     /**
      * @brief Constructs a DisplayBase object.
      * @param app A reference to the app.
      */
-    DisplayBase(pvtui::App& app) : pvgroup(app.pvgroup) {}
+    DisplayBase(pvtui::App& app) : DisplayBase(app.pvgroup) {}
+
+    DisplayBase(const DisplayBase&) = delete;
+    DisplayBase& operator=(const DisplayBase&) = delete;
 
     /**
-     * @brief Destroys the DisplayBase object.
+     * @brief Destroys the DisplayBase object, releasing its PVs.
      */
-    virtual ~DisplayBase() = default;
+    virtual ~DisplayBase() { pvgroup.end_capture(subscriptions_, false); }
+
+    /**
+     * @brief Connects and monitors the display's PVs, e.g. when its tab is shown.
+     */
+    void activate() { this->set_active(true); }
+
+    /**
+     * @brief Cancels the monitors of the display's PVs which no active display uses.
+     */
+    void deactivate() { this->set_active(false); }
+
+    /**
+     * @brief Checks if the display is active.
+     * @return True unless deactivate() was called after the last activate().
+     */
+    bool active() const { return active_; }
 
     /**
      * @brief Checks if new data is available from and of the monitors in the group
@@ -49,7 +90,27 @@ class DisplayBase {
     virtual ftxui::Component get_container() = 0;
 
   protected:
+    /**
+     * @brief Stops adding the PVs of new widgets to the display.
+     *
+     * Must be called at the end of the derived class's constructor. Otherwise widgets
+     * created before the next PVGroup::sync() are paused along with the display.
+     */
+    void end_construction() { pvgroup.stop_capture(subscriptions_); }
+
     pvtui::PVGroup& pvgroup; ///< Reference to the PVGroup instance.
+
+  private:
+    void set_active(bool active) {
+        pvgroup.end_capture(subscriptions_, active);
+        active_ = active;
+        for (auto& subscription : subscriptions_) {
+            subscription.set_active(active);
+        }
+    }
+
+    std::vector<pvtui::Subscription> subscriptions_; ///< Subscriptions taken by the display's widgets.
+    bool active_ = true;                             ///< Set by activate(), cleared by deactivate().
 };
 
 } // namespace pvtui
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+#include <pvtui/metrics.hpp>
+
+namespace pvtui {
+
+namespace {
+
+// Writes a string as the contents of a JSON string literal
+void write_escaped(std::ostream& out, const std::string& str) {
+    for (const char c : str) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec
+                << std::setfill(' ');
+        } else {
+            out << c;
+        }
+    }
+}
+
+} // namespace
+
+LatencyHistogram::Snapshot& LatencyHistogram::Snapshot::operator-=(const Snapshot& older) {
+    for (size_t i = 0; i < NUM_BUCKETS; i++) {
+        counts[i] -= std::min(counts[i], older.counts[i]);
+    }
+    count -= std::min(count, older.count);
+    sum_ns -= std::min(sum_ns, older.sum_ns);
+    return *this;
+}
+
+std::chrono::nanoseconds LatencyHistogram::Snapshot::percentile(double q) const {
+    if (count == 0) {
+        return std::chrono::nanoseconds{0};
+    }
+    // rank of the wanted duration, counting from 1
+    const double clamped = std::clamp(q, 0.0, 1.0);
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped * count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            constexpr uint64_t limit = std::numeric_limits<std::chrono::nanoseconds::rep>::max();
+            return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(
+                std::min(bucket_max(i), limit))};
+        }
+    }
+    return std::chrono::nanoseconds{0};
+}
+
+DurationStats LatencyHistogram::Snapshot::stats() const {
+    DurationStats out;
+    out.count = count;
+    if (count > 0) {
+        out.mean = std::chrono::nanoseconds{static_cast<int64_t>(sum_ns / count)};
+    }
+    out.p50 = percentile(0.50);
+    out.p90 = percentile(0.90);
+    out.p99 = percentile(0.99);
+    out.max = percentile(1.0);
+    return out;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot out;
+    // recorders may run meanwhile, so the sum and counts can disagree by a few durations
+    out.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < NUM_BUCKETS; i++) {
+        out.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        out.count += out.counts[i];
+    }
+    return out;
+}
+
+uint64_t LatencyHistogram::bucket_max(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    const unsigned shift = static_cast<unsigned>(index / SUB_BUCKETS) - 1;
+    const uint64_t low = static_cast<uint64_t>(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return low + ((uint64_t{1} << shift) - 1);
+}
+
+TraceWriter::TraceWriter(const std::string& path)
+    : out_(path, std::ios::out | std::ios::trunc), origin_(std::chrono::system_clock::now()) {
+    if (!out_) {
+        throw std::runtime_error("Can't open trace file " + path);
+    }
+    out_ << std::fixed << std::setprecision(3) << "[";
+}
+
+TraceWriter::~TraceWriter() { out_ << "\n]\n"; }
+
+void TraceWriter::write(const std::string& pv, const UpdateTrace& trace, UpdateTrace::time_point painted) {
+    id_++;
+    const bool has_source = trace.source != UpdateTrace::time_point{};
+    // a server clock running ahead of ours would otherwise break the nesting
+    const auto begin = has_source ? std::min(trace.source, trace.received) : trace.received;
+    this->event(pv, 'b', begin);
+    if (has_source) {
+        this->event("network", 'b', begin);
+        this->event("network", 'e', trace.received);
+    }
+    this->event("queued", 'b', trace.received);
+    this->event("queued", 'e', trace.synced);
+    this->event("frame", 'b', trace.synced);
+    this->event("frame", 'e', painted);
+    this->event(pv, 'e', painted);
+}
+
+void TraceWriter::event(const std::string& name, char phase, UpdateTrace::time_point time) {
+    const double ts = std::chrono::duration<double, std::micro>(time - origin_).count();
+    out_ << (first_ ? "\n" : ",\n") << "{\"name\":\"";
+    write_escaped(out_, name);
+    out_ << "\",\"cat\":\"pvtui\",\"ph\":\"" << phase << "\",\"id\":" << id_
+         << ",\"pid\":1,\"tid\":1,\"ts\":" << ts << "}";
+    first_ = false;
+}
+
+} // namespace pvtui
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pvtui {
+
+/**
+ * @brief Summary of a set of recorded durations.
+ *
+ * Percentiles and the maximum are the upper bound of the histogram bucket they
+ * fall in, so they overestimate by at most 1/8 of the value.
+ */
+struct DurationStats {
+    uint64_t count = 0;               ///< Number of recorded durations.
+    std::chrono::nanoseconds mean{0}; ///< Average duration.
+    std::chrono::nanoseconds p50{0};  ///< Median duration.
+    std::chrono::nanoseconds p90{0};  ///< 90th percentile.
+    std::chrono::nanoseconds p99{0};  ///< 99th percentile.
+    std::chrono::nanoseconds max{0};  ///< Longest duration.
+};
+
+/**
+ * @brief Log-linear histogram of durations, cheap enough to record into on every event.
+ *
+ * Each power of two of nanoseconds is split into 8 buckets, as in HdrHistogram
+ * with one significant digit, so any duration up to centuries is kept with a
+ * relative error below 12.5% in a fixed 4 kB of counters. record() is one
+ * relaxed atomic increment per counter and never blocks, so any number of
+ * threads may record while another takes a snapshot().
+ */
+class LatencyHistogram {
+  public:
+    /// @brief Number of linear buckets in each power of two.
+    static constexpr unsigned SUB_BUCKETS = 8;
+
+    /// @brief Total number of buckets, enough for any 64-bit number of nanoseconds.
+    static constexpr size_t NUM_BUCKETS = (64 - 3 + 1) * SUB_BUCKETS;
+
+    /**
+     * @brief Copy of a histogram's counts at one point in time.
+     *
+     * Subtracting an older snapshot of the same histogram gives the durations
+     * recorded in between.
+     */
+    struct Snapshot {
+        std::array<uint64_t, NUM_BUCKETS> counts{}; ///< Number of durations in each bucket.
+        uint64_t count = 0;                         ///< Sum of counts.
+        uint64_t sum_ns = 0;                        ///< Sum of the recorded durations.
+
+        /**
+         * @brief Removes the durations of an older snapshot of the same histogram.
+         * @param older The earlier snapshot.
+         * @return A reference to this snapshot.
+         */
+        Snapshot& operator-=(const Snapshot& older);
+
+        /**
+         * @brief Gets the duration below which a fraction of the recorded durations fall.
+         * @param q The fraction, from 0 to 1.
+         * @return The upper bound of the bucket holding that duration, or zero if empty.
+         */
+        std::chrono::nanoseconds percentile(double q) const;
+
+        /**
+         * @brief Summarizes the snapshot.
+         * @return The count, mean, percentiles and maximum.
+         */
+        DurationStats stats() const;
+    };
+
+    /**
+     * @brief Records one duration. Safe to call from any thread.
+     * @param duration The duration, negative values are counted as zero.
+     */
+    void record(std::chrono::nanoseconds duration) {
+        const uint64_t ns = duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0;
+        counts_[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+        sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Copies the current counts. Safe to call from any thread.
+     *
+     * Durations recorded concurrently may be missing from the copy, but are never counted twice.
+     * @return The snapshot.
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * @brief Gets the bucket a duration is counted in.
+     * @param ns The duration in nanoseconds.
+     * @return The bucket index, less than NUM_BUCKETS.
+     */
+    static size_t bucket(uint64_t ns) {
+        if (ns < SUB_BUCKETS) {
+            return static_cast<size_t>(ns);
+        }
+        // position of the highest set bit, at least 3
+        unsigned msb = 3;
+        for (unsigned step = 32; step > 0; step /= 2) {
+            if (msb + step < 64 && (ns >> (msb + step))) {
+                msb += step;
+            }
+        }
+        const unsigned shift = msb - 3;
+        return (shift + 1) * SUB_BUCKETS + ((ns >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    /**
+     * @brief Gets the largest duration counted in a bucket.
+     * @param index The bucket index.
+     * @return The bucket's inclusive upper bound in nanoseconds.
+     */
+    static uint64_t bucket_max(size_t index);
+
+  private:
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> counts_{}; ///< Number of durations in each bucket.
+    std::atomic<uint64_t> sum_ns_ = 0;                        ///< Sum of the recorded durations.
+};
+
+/**
+ * @brief Wall clock times at which one monitor update passed each stage of pvtui.
+ *
+ * All times are from std::chrono::system_clock so they can be compared with the
+ * server's timeStamp. A zero time means the stage was not recorded.
+ */
+struct UpdateTrace {
+    using time_point = std::chrono::system_clock::time_point;
+
+    time_point source;   ///< The update's timeStamp. Zero if it has none or is a PV's initial value.
+    time_point received; ///< When the monitor callback took the update from the queue.
+    time_point synced;   ///< When PVGroup::sync() copied it to the monitored variables.
+};
+
+/**
+ * @brief Latency histograms of the stages an update passes, from its timeStamp to the terminal.
+ *
+ * The source stages compare the server's clock with the local one, so across
+ * hosts they include any clock offset.
+ */
+struct LatencyStages {
+    LatencyHistogram source_to_callback; ///< timeStamp until the monitor callback.
+    LatencyHistogram callback_to_sync;   ///< Monitor callback until PVGroup::sync().
+    LatencyHistogram sync_to_paint;      ///< PVGroup::sync() until the frame was drawn.
+    LatencyHistogram source_to_paint;    ///< timeStamp until the frame was drawn.
+};
+
+/**
+ * @brief Latency of one PV's updates, kept while latency tracing is enabled.
+ */
+struct PVLatency {
+    std::string name;                 ///< The PV name.
+    LatencyHistogram source_to_paint; ///< timeStamp until the frame showing the update was drawn.
+};
+
+/**
+ * @brief Writes update traces to a file in the Chrome trace event JSON format.
+ *
+ * Each update is an async event named after its PV, from its timeStamp to the
+ * drawn frame, nested with one event per stage: network (timeStamp to monitor
+ * callback), queued (callback to sync) and frame (sync to drawn). The file loads
+ * in chrome://tracing and in Perfetto, also when the program stops without
+ * closing it. Not thread safe.
+ */
+class TraceWriter {
+  public:
+    /**
+     * @brief Creates or truncates the trace file.
+     * @param path The file to write.
+     * @throws std::runtime_error if the file can't be opened.
+     */
+    explicit TraceWriter(const std::string& path);
+
+    /**
+     * @brief Ends the JSON array and closes the file.
+     */
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    /**
+     * @brief Writes the events of one update.
+     * @param pv The PV name.
+     * @param trace The stages the update passed.
+     * @param painted When the frame showing the update was drawn.
+     */
+    void write(const std::string& pv, const UpdateTrace& trace, UpdateTrace::time_point painted);
+
+  private:
+    /// @brief Writes one async begin or end event.
+    void event(const std::string& name, char phase, UpdateTrace::time_point time);
+
+    std::ofstream out_;              ///< The trace file.
+    UpdateTrace::time_point origin_; ///< Time 0 of the trace.
+    uint64_t id_ = 0;                ///< Id of the update being written.
+    bool first_ = true;              ///< No event has been written yet.
+};
+
+/**
+ * @brief Runtime statistics of a single PV.
+ */
+struct PVMetrics {
+    std::string name;                         ///< The PV name.
+    bool connected = false;                   ///< Whether the channel is connected.
+    uint64_t monitor_events = 0;              ///< Monitor updates received since the PV was added.
+    double events_per_sec = 0.0;              ///< Monitor updates per second over the last window.
+    size_t dropped_updates = 0;               ///< See PVHandler::dropped_updates().
+    size_t conversion_errors = 0;             ///< See PVHandler::conversion_errors().
+    DurationStats source_to_paint;            ///< timeStamp until drawn over the run, see App::metrics().
+    std::shared_ptr<const PVLatency> latency; ///< The PV's latency histogram, null unless tracing.
+};
+
+/**
+ * @brief Runtime statistics of an App, returned by App::metrics().
+ *
+ * Rates and durations cover the last completed window of about one second,
+ * totals cover the whole run.
+ */
+struct Metrics {
+    std::chrono::nanoseconds window{0}; ///< Length of the window rates and durations cover.
+
+    uint64_t monitor_events = 0;  ///< Monitor updates received by all PVs.
+    double events_per_sec = 0.0;  ///< Monitor updates per second, summed over all PVs.
+    size_t dropped_updates = 0;   ///< Updates merged into a newer one, summed over all PVs.
+    size_t conversion_errors = 0; ///< Updates which failed to convert, summed over all PVs.
+
+    DurationStats sync;          ///< Time spent in PVGroup::sync().
+    size_t last_sync_pvs = 0;    ///< PVs waiting in the dirty list at the last sync().
+    DurationStats frame_build;   ///< Time to build the element tree of a frame.
+    DurationStats frame;         ///< Data-driven frames, from their sync until drawn to the terminal.
+    double frames_per_sec = 0.0; ///< Frames built per second.
+
+    size_t puts_pending = 0;   ///< Puts queued or in flight.
+    size_t puts_coalesced = 0; ///< Puts merged into a waiting put.
+    DurationStats put_latency; ///< Puts from PVHandler::put() until the server's response.
+
+    size_t pvs = 0;       ///< PVs in the group.
+    size_t connected = 0; ///< PVs whose channel is connected.
+
+    DurationStats source_to_callback; ///< Updates from their timeStamp until the monitor callback.
+    DurationStats callback_to_sync;   ///< Updates from the monitor callback until PVGroup::sync().
+    DurationStats sync_to_paint;      ///< Updates from PVGroup::sync() until their frame was drawn.
+    DurationStats source_to_paint;    ///< Updates from their timeStamp until their frame was drawn.
+
+    std::vector<PVMetrics> per_pv; ///< One entry per PV, in no particular order.
+};
+
+} // namespace pvtui
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+
+#include <pv/pvData.h>
+
+#include <pvtui/pvgroup.hpp>
+#include <pvtui/put_queue.hpp>
+
+namespace pvd = epics::pvData;
+
+namespace pvtui {
+
+/**
+ * @brief A single put started by the PutQueue worker.
+ */
+class PutQueue::Operation : public pvac::ClientChannel::PutCallback {
+  public:
+    Operation(PutQueue& queue, Request request) : queue_(queue), request_(std::move(request)) {}
+
+    ~Operation() override { op_.cancel(); }
+
+    /// @brief Starts the put. Called from the worker thread without holding the queue lock.
+    void start() {
+        try {
+            op_ = request_.pv->channel.put(this);
+        } catch (std::exception& e) {
+            this->complete({PutStatus::State::Failed, e.what()});
+        }
+    }
+
+    /// @brief Checks whether the put has completed and the Operation can be freed.
+    bool done() const { return done_.load(std::memory_order_acquire); }
+
+    void putBuild(const pvd::StructureConstPtr& build, Args& args) override final {
+        pvd::PVStructurePtr root = pvd::getPVDataCreate()->createPVStructure(build);
+        auto field = root->getSubField<pvd::PVScalar>(request_.field);
+        if (!field) {
+            // enums are written through their index
+            field = root->getSubField<pvd::PVScalar>(request_.field + ".index");
+        }
+        if (!field) {
+            throw std::runtime_error("No scalar field " + request_.field + " in " + request_.pv->name);
+        }
+        std::visit(
+            [&field](const auto& val) {
+                using T = std::decay_t<decltype(val)>;
+                field->putFrom<T>(val);
+            },
+            request_.value);
+        args.tosend.set(field->getFieldOffset());
+        args.root = root;
+    }
+
+    void putDone(const pvac::PutEvent& evt) override final {
+        switch (evt.event) {
+        case pvac::PutEvent::Success:
+            this->complete({PutStatus::State::Success, ""});
+            break;
+        case pvac::PutEvent::Fail:
+            this->complete({PutStatus::State::Failed, evt.message});
+            break;
+        case pvac::PutEvent::Cancel:
+            this->complete({PutStatus::State::Failed, "Put cancelled"});
+            break;
+        }
+    }
+
+  private:
+    void complete(const PutStatus& status) {
+        // The worker may free this Operation as soon as done_ is set
+        PutQueue& queue = queue_;
+        PVHandler& pv = *request_.pv;
+        queue.latency_.record(std::chrono::steady_clock::now() - request_.queued);
+        done_.store(true, std::memory_order_release);
+        queue.finished(pv, status);
+    }
+
+    PutQueue& queue_;
+    Request request_;
+    pvac::Operation op_;
+    std::atomic<bool> done_{false};
+};
+
+PutQueue::PutQueue() = default;
+
+PutQueue::~PutQueue() { this->stop(); }
+
+PutQueue::Result PutQueue::put(PVHandler& pv, const std::string& field, PutValue value, PutPolicy policy) {
+    const auto now = std::chrono::steady_clock::now();
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_) {
+            return Result::Stopped;
+        }
+
+        // A PV in waiting_ has a put in flight, so this one has to wait its turn
+        auto it = waiting_.find(&pv);
+        if (it != waiting_.end()) {
+            Waiting& waiting = it->second;
+            if (policy == PutPolicy::LastValue && !waiting.empty() && waiting.back().field == field &&
+                waiting.back().policy == PutPolicy::LastValue) {
+                waiting.back().value = std::move(value);
+                coalesced_++;
+                return Result::Coalesced;
+            }
+            waiting.push_back({&pv, field, std::move(value), policy, now});
+            return Result::Queued;
+        }
+
+        waiting_.emplace(&pv, Waiting{});
+        if (!worker_.joinable()) {
+            worker_ = std::thread(&PutQueue::run, this);
+        }
+        queue_.push_back({&pv, field, std::move(value), policy, now});
+    }
+    cv_.notify_one();
+    return Result::Queued;
+}
+
+void PutQueue::stop() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        queue_.clear();
+        waiting_.clear();
+    }
+    cv_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+
+    // Cancelling may invoke putDone(), which takes the lock
+    std::vector<std::unique_ptr<Operation>> ops;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        ops.swap(in_flight_);
+    }
+    ops.clear();
+}
+
+size_t PutQueue::pending() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto running =
+        std::count_if(in_flight_.begin(), in_flight_.end(), [](const auto& op) { return !op->done(); });
+    size_t waiting = 0;
+    for (const auto& [pv, requests] : waiting_) {
+        waiting += requests.size();
+    }
+    return queue_.size() + waiting + static_cast<size_t>(running);
+}
+
+size_t PutQueue::coalesced() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return coalesced_;
+}
+
+bool PutQueue::idle(const PVHandler& pv) const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    // a PV is in waiting_ from its first put until finished() has handled the last one
+    return waiting_.find(&pv) == waiting_.end();
+}
+
+void PutQueue::finished(PVHandler& pv, const PutStatus& status) {
+    pv.put_done(status);
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        reap_ = true;
+        // Start the next put to this PV, if any
+        auto it = waiting_.find(&pv);
+        if (it != waiting_.end()) {
+            if (it->second.empty()) {
+                waiting_.erase(it);
+            } else {
+                queue_.push_back(std::move(it->second.front()));
+                it->second.pop_front();
+            }
+        }
+    }
+    cv_.notify_one();
+}
+
+void PutQueue::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopped_ || reap_ || !queue_.empty(); });
+        if (stopped_) {
+            return;
+        }
+
+        std::vector<std::unique_ptr<Operation>> done;
+        if (reap_) {
+            reap_ = false;
+            auto first_done = std::stable_partition(in_flight_.begin(), in_flight_.end(),
+                                                    [](const auto& op) { return !op->done(); });
+            std::move(first_done, in_flight_.end(), std::back_inserter(done));
+            in_flight_.erase(first_done, in_flight_.end());
+        }
+
+        // Register the new operations before starting them so stop() can cancel them
+        std::vector<Operation*> starting;
+        for (auto& request : queue_) {
+            in_flight_.push_back(std::make_unique<Operation>(*this, std::move(request)));
+            starting.push_back(in_flight_.back().get());
+        }
+        queue_.clear();
+
+        lock.unlock();
+        done.clear();
+        for (Operation* op : starting) {
+            op->start();
+        }
+        lock.lock();
+    }
+}
+
+} // namespace pvtui
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include <pva/client.h>
+
+#include <pvtui/metrics.hpp>
+
+namespace pvtui {
+
+struct PVHandler;
+
+/**
+ * @brief A value written to a PV field by PutQueue.
+ */
+using PutValue = std::variant<int, double, std::string>;
+
+/**
+ * @brief How a put is combined with earlier puts to the same PV that have not started yet.
+ */
+enum class PutPolicy {
+    LastValue, ///< Replace a waiting put to the same field, e.g. for setpoints and menus.
+    KeepAll,   ///< Send every write in order, e.g. for PROC fields and tweak buttons.
+};
+
+/**
+ * @brief Outcome of the puts issued to a PV.
+ */
+struct PutStatus {
+    /**
+     * @brief State of the most recent put.
+     */
+    enum class State {
+        Idle,    ///< No put has been issued.
+        Pending, ///< A put is waiting for the server to respond.
+        Success, ///< The last completed put succeeded.
+        Failed,  ///< The last completed put failed or was cancelled.
+    };
+
+    State state = State::Idle; ///< Current state.
+    std::string message;       ///< Error message when state is Failed.
+};
+
+/**
+ * @brief Issues PV puts from a worker thread so callers never block on network I/O.
+ *
+ * put() only queues the request. The worker starts each put with pvac's
+ * callback-based API, and when the server responds the result is handed to the
+ * PVHandler, which publishes it on its next sync().
+ *
+ * Each PV has at most one put in flight. Puts issued meanwhile wait in a per-PV
+ * queue, where a PutPolicy::LastValue put replaces a waiting put to the same
+ * field, so a held-down key or a scrolled menu sends only the newest value once
+ * the server catches up.
+ */
+class PutQueue {
+  public:
+    /**
+     * @brief Constructs a PutQueue. The worker thread is started by the first put().
+     */
+    PutQueue();
+
+    /**
+     * @brief Stops the worker and cancels any puts still in flight.
+     */
+    ~PutQueue();
+
+    PutQueue(const PutQueue&) = delete;
+    PutQueue& operator=(const PutQueue&) = delete;
+
+    /**
+     * @brief Outcome of put().
+     */
+    enum class Result {
+        Queued,    ///< The put will complete through PVHandler::put_done().
+        Coalesced, ///< The put replaced a waiting put and will not complete on its own.
+        Stopped,   ///< The queue was stopped and the put was dropped.
+    };
+
+    /**
+     * @brief Queues a put and returns immediately.
+     * @param pv The PV to write to. Must stay alive until stop() is called.
+     * @param field The field to write, e.g. "value" or "value.index".
+     * @param value The value to write.
+     * @param policy How to combine the put with waiting puts to the same PV.
+     * @return Whether the put was queued, merged into a waiting put, or dropped.
+     */
+    Result put(PVHandler& pv, const std::string& field, PutValue value,
+             PutPolicy policy = PutPolicy::LastValue);
+
+    /**
+     * @brief Stops the worker thread and cancels all queued and in-flight puts.
+     *
+     * Called by the destructor, and by owners that must make sure no callbacks
+     * run after their PVHandlers are destroyed. Further calls are no-ops.
+     */
+    void stop();
+
+    /**
+     * @brief Gets the number of puts queued or waiting for a response.
+     * @return The number of unfinished puts.
+     */
+    size_t pending() const;
+
+    /**
+     * @brief Gets the number of puts merged into a waiting put instead of being sent.
+     * @return The total number of coalesced puts.
+     */
+    size_t coalesced() const;
+
+    /**
+     * @brief Checks if the queue holds no puts to a PV and will not call back into it.
+     * @param pv The PV to check.
+     * @return True if no put to pv is queued, waiting or in flight.
+     */
+    bool idle(const PVHandler& pv) const;
+
+    /**
+     * @brief Gets the latency of the completed puts. Safe to call from any thread.
+     *
+     * Each put is timed from put() until the server's response, so the time spent
+     * waiting behind an earlier put to the same PV is included. A coalesced put
+     * completes with the put it was merged into, which keeps its original start time.
+     * @return The histogram of put latencies.
+     */
+    const LatencyHistogram& latency() const { return latency_; }
+
+  private:
+    struct Request {
+        PVHandler* pv;
+        std::string field;
+        PutValue value;
+        PutPolicy policy;
+        std::chrono::steady_clock::time_point queued; ///< When put() was called.
+    };
+
+    /// @brief Puts to a PV which has a put in flight, in the order they are sent.
+    using Waiting = std::deque<Request>;
+
+    class Operation;
+
+    /// @brief Worker loop which starts queued puts and frees completed ones.
+    void run();
+
+    /// @brief Called by an Operation once its put has completed.
+    void finished(PVHandler& pv, const PutStatus& status);
+
+    mutable std::mutex mutex_;                              ///< Protects the members below.
+    std::condition_variable cv_;                            ///< Wakes the worker.
+    bool stopped_ = false;                                  ///< Set by stop().
+    bool reap_ = false;                                     ///< An operation finished since the last pass.
+    std::deque<Request> queue_;                             ///< Puts ready to be started.
+    std::unordered_map<const PVHandler*, Waiting> waiting_; ///< Puts queued behind one in flight, by PV.
+    size_t coalesced_ = 0;                                  ///< Number of puts merged into a waiting one.
+    std::vector<std::unique_ptr<Operation>> in_flight_;     ///< Started puts not yet freed.
+    LatencyHistogram latency_;                              ///< Time from put() to completion.
+    std::thread worker_;                                    ///< Runs run().
+};
+
+} // namespace pvtui
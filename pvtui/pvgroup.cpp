@@ -1,10 +1,16 @@
-#include <cstdlib>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <iomanip>
-#include <iostream>
+#include <iterator>
+#include <map>
 #include <sstream>
 
+#include <pv/createRequest.h>
+
 #include <pvtui/pvgroup.hpp>
 #include <type_traits>
+#include <utility>
 
 namespace pvd = epics::pvData;
 
@@ -19,6 +25,15 @@ struct is_vector<std::vector<T, Alloc>> : std::true_type {};
 template <typename T>
 inline constexpr bool is_vector_v = is_vector<T>::value;
 
+template <typename T>
+struct is_array_view : std::false_type {};
+
+template <typename T>
+struct is_array_view<pvtui::ArrayView<T>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_array_view_v = is_array_view<T>::value;
+
 } // namespace
 
 namespace pvtui {
@@ -29,21 +44,74 @@ void ConnectionMonitor::connectEvent(const pvac::ConnectEvent& event) {
 
 bool ConnectionMonitor::connected() const { return connected_.load(std::memory_order_relaxed); }
 
-PVHandler::PVHandler(pvac::ClientProvider& provider, const std::string& pv_name)
-    : channel(provider.connect(pv_name)), name(pv_name), monitor_(channel.monitor(this)),
-      connection_monitor_(std::make_shared<ConnectionMonitor>()) {
-    channel.addConnectListener(connection_monitor_.get());
+void DirtyList::push(PVHandler& pv) {
+    if (pv.dirty_queued_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    // Once the CAS succeeds the consumer may take pv and another thread push it
+    // again, so the old head is kept in a local rather than read back from pv
+    PVHandler* head = head_.load(std::memory_order_relaxed);
+    do {
+        pv.dirty_next_ = head;
+    } while (!head_.compare_exchange_weak(head, &pv, std::memory_order_release, std::memory_order_relaxed));
+    // Only the first push after the consumer emptied the list needs to wake it
+    if (head == nullptr) {
+        this->notify();
+    }
+}
+
+void DirtyList::wait() {
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    wait_cv_.wait(lock, [this] { return signaled_; });
+    signaled_ = false;
+}
+
+bool DirtyList::wait_for(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    bool woken = wait_cv_.wait_for(lock, timeout, [this] { return signaled_; });
+    signaled_ = false;
+    return woken;
+}
+
+void DirtyList::notify() {
+    {
+        const std::lock_guard<std::mutex> lock(wait_mutex_);
+        signaled_ = true;
+    }
+    wait_cv_.notify_one();
+}
+
+PVHandler* DirtyList::take_all() { return head_.exchange(nullptr, std::memory_order_acquire); }
+
+PVHandler::PVHandler(pvac::ClientProvider& provider, const std::string& pv_name,
+                     std::shared_ptr<DirtyList> dirty_list, std::shared_ptr<PutQueue> put_queue, bool paused)
+    : name(pv_name), metadata_(std::make_shared<PVMetadata>()),
+      connection_monitor_(std::make_shared<ConnectionMonitor>()), provider_(provider), paused_(paused),
+      dirty_list_(std::move(dirty_list)), put_queue_(std::move(put_queue)) {
+    if (!paused) {
+        this->open_channel();
+    }
+}
+
+void PVHandler::open_channel() {
+    if (!channel_open_) {
+        channel = provider_.connect(name);
+        channel.addConnectListener(connection_monitor_.get());
+        channel_open_ = true;
+    }
 }
 
 void PVHandler::monitorEvent(const pvac::MonitorEvent& evt) {
     switch (evt.event) {
     case pvac::MonitorEvent::Data:
-        while (monitor_.poll()) {
-            this->update_monitored_variable(monitor_.root.get());
-        }
+        this->poll_monitor();
         break;
-    case pvac::MonitorEvent::Disconnect:
+    case pvac::MonitorEvent::Disconnect: {
+        // the server sends the current value again on reconnect
+        const std::lock_guard<std::mutex> lock(monitor_mutex_);
+        initial_update_ = true;
         break;
+    }
     case pvac::MonitorEvent::Fail:
         break;
     case pvac::MonitorEvent::Cancel:
@@ -51,21 +119,130 @@ void PVHandler::monitorEvent(const pvac::MonitorEvent& evt) {
     }
 }
 
+void PVHandler::poll_monitor() {
+    const std::lock_guard<std::mutex> lock(monitor_mutex_);
+    if (!monitor_started_) {
+        return;
+    }
+    if (!monitor_.poll()) {
+        return;
+    }
+    // poll() copies each update's changed fields into root, so after draining the
+    // queue root holds the newest value and only the union of the changes is needed
+    drained_changed_ = monitor_.changed;
+    size_t dropped = 0;
+    while (monitor_.poll()) {
+        drained_changed_ |= monitor_.changed;
+        dropped++;
+    }
+    // only the thread delivering this PV's monitor callbacks writes its counters
+    monitor_events_.fetch_add(dropped + 1, std::memory_order_relaxed);
+    if (dropped > 0) {
+        dropped_updates_.fetch_add(dropped, std::memory_order_relaxed);
+    }
+    this->update_monitored_variable(monitor_.root, drained_changed_);
+}
+
+void PVHandler::stop_monitor() {
+    pvac::Monitor old;
+    bool had_monitor = false;
+    {
+        const std::lock_guard<std::mutex> lock(monitor_mutex_);
+        std::swap(had_monitor, monitor_started_);
+        old = monitor_;
+        monitor_ = pvac::Monitor();
+        metadata_root_ = nullptr;
+        initial_update_ = true;
+    }
+    // cancel() waits for running callbacks, so it must not hold the lock
+    if (had_monitor) {
+        old.cancel();
+    }
+}
+
+void PVHandler::restart_monitor() {
+    this->stop_monitor();
+
+    const std::string request = slots_.request(metadata_requested_, tracing_.load(std::memory_order_relaxed));
+    if (closed_ || paused_ || request.empty()) {
+        return;
+    }
+    pvac::Monitor mon = channel.monitor(this, pvd::createRequest(request));
+    {
+        const std::lock_guard<std::mutex> lock(monitor_mutex_);
+        monitor_ = mon;
+        monitor_started_ = true;
+    }
+    // Data delivered before monitor_ was set was not polled by the callback
+    this->poll_monitor();
+}
+
+void PVHandler::unset_monitor(size_t slot, const void* var) {
+    const bool tracing = tracing_.load(std::memory_order_relaxed);
+    const std::string before = slots_.request(metadata_requested_, tracing);
+    if (slots_.remove(slot, var) && slots_.request(metadata_requested_, tracing) != before) {
+        this->restart_monitor();
+    }
+}
+
+void PVHandler::close() {
+    closed_ = true;
+    this->stop_monitor();
+    if (channel_open_) {
+        channel.removeConnectListener(connection_monitor_.get());
+    }
+}
+
+void PVHandler::pause() {
+    if (!paused_.exchange(true)) {
+        this->stop_monitor();
+    }
+}
+
+void PVHandler::resume() {
+    if (paused_.exchange(false) && !closed_) {
+        this->open_channel();
+        this->restart_monitor();
+    }
+}
+
+void PVHandler::monitor_metadata() {
+    if (!metadata_requested_) {
+        metadata_requested_ = true;
+        if (!slots_.empty()) {
+            this->restart_monitor();
+        }
+    }
+}
+
+void PVHandler::trace_latency() {
+    if (tracing_.exchange(true)) {
+        return;
+    }
+    auto latency = std::make_shared<PVLatency>();
+    latency->name = name;
+    std::atomic_store(&latency_, std::move(latency));
+    if (!slots_.empty()) {
+        this->restart_monitor();
+    }
+}
+
 bool PVHandler::connected() const { return connection_monitor_->connected(); }
 
 namespace {
 
-size_t get_precision(const epics::pvData::PVStructure* pstruct) {
-    size_t prec = 4;
+int get_precision(const epics::pvData::PVStructure* pstruct) {
+    int prec = 4;
     if (auto display_struct = pstruct->getSubField<epics::pvData::PVStructure>("display")) {
         if (auto format_field = display_struct->getSubField<epics::pvData::PVString>("format")) {
-            std::string fstr = format_field->get();
+            const std::string& fstr = format_field->get();
             size_t iF = fstr.find('F');
             size_t idot = fstr.find('.');
             if (iF != std::string::npos && idot != std::string::npos) {
-                try {
-                    prec = std::stoi(fstr.substr(idot + 1));
-                } catch (...) {
+                int parsed = 0;
+                const char* first = fstr.data() + idot + 1;
+                if (std::from_chars(first, fstr.data() + fstr.size(), parsed).ec == std::errc()) {
+                    prec = parsed;
                 }
             }
         }
@@ -73,8 +250,8 @@ size_t get_precision(const epics::pvData::PVStructure* pstruct) {
     return prec;
 }
 
-// type map for convenience in vector<T> branch
-// of visitor in update_monitored_variable
+// type map for convenience in vector<T> and ArrayView<T>
+// branches of visitor in MonitorSlots::convert
 template <typename T>
 struct pvd_type_map;
 template <>
@@ -90,159 +267,871 @@ struct pvd_type_map<std::string> {
     using array_type = pvd::PVStringArray;
 };
 
+// Sets var to the alternative at index if it does not already hold it.
+// Only allocates the first time a buffer's slot is used.
+template <size_t... I>
+void emplace_index(MonitorVar& var, size_t index, std::index_sequence<I...>) {
+    if (var.index() != index) {
+        ((index == I ? (void)var.emplace<I>() : void()), ...);
+    }
+}
+
+// Copies a slot holding a T to each of its user variables
+template <typename T>
+void copy_slot(const MonitorVar& data, const std::vector<void*>& vars) {
+    if (const T* val = std::get_if<T>(&data)) {
+        for (void* var : vars) {
+            *static_cast<T*>(var) = *val;
+        }
+    }
+}
+
+using CopySlotFn = void (*)(const MonitorVar&, const std::vector<void*>&);
+
+template <size_t... I>
+constexpr std::array<CopySlotFn, sizeof...(I)> make_copy_table(std::index_sequence<I...>) {
+    return {&copy_slot<std::variant_alternative_t<I, MonitorVar>>...};
+}
+
+// copy_slot instantiated for each MonitorVar alternative, indexed like the slots
+constexpr auto COPY_SLOT = make_copy_table(std::make_index_sequence<std::variant_size_v<MonitorVar>>{});
+
 } // namespace
 
-void PVHandler::update_monitored_variable(const pvd::PVStructure* pstruct) {
+ChoiceTable::ChoiceTable() {
+    static const auto empty_labels = std::make_shared<const std::vector<std::string>>();
+    labels_ = empty_labels;
+}
 
-    // Copy all monitor slots under lock
-    std::unordered_map<std::type_index, MonitorVar> slots_copy;
-    {
-        const std::lock_guard<std::mutex> lock(mutex_);
-        for (auto& [type_id, slot] : monitor_slots_) {
-            if (!std::holds_alternative<std::monostate>(slot.data)) {
-                slots_copy.emplace(type_id, slot.data);
-            }
+ChoiceTable::ChoiceTable(std::shared_ptr<const std::vector<std::string>> labels)
+    : labels_(std::move(labels)) {}
+
+ChoiceTable ChoiceTable::intern(std::vector<std::string> labels) {
+    static std::mutex pool_mutex;
+    static std::map<std::vector<std::string>, std::weak_ptr<const std::vector<std::string>>> pool;
+
+    const std::lock_guard<std::mutex> lock(pool_mutex);
+    auto it = pool.find(labels);
+    if (it != pool.end()) {
+        if (auto shared = it->second.lock()) {
+            return ChoiceTable(std::move(shared));
+        }
+        pool.erase(it);
+    }
+
+    // Interning only happens when a PV's labels change, so sweeping here is cheap
+    for (auto entry = pool.begin(); entry != pool.end();) {
+        entry = entry->second.expired() ? pool.erase(entry) : std::next(entry);
+    }
+    auto shared = std::make_shared<const std::vector<std::string>>(labels);
+    pool.emplace(std::move(labels), shared);
+    return ChoiceTable(std::move(shared));
+}
+
+const std::string& PVEnum::choice() const {
+    static const std::string none;
+    return index >= 0 && static_cast<size_t>(index) < choices.size() ? choices[index] : none;
+}
+
+void PVMetadata::update(const pvd::PVStructure& pstruct) {
+    precision = get_precision(&pstruct);
+    if (auto display = pstruct.getSubField<pvd::PVStructure>("display")) {
+        if (auto field = display->getSubField<pvd::PVString>("units")) {
+            units = field->get();
+        }
+        if (auto field = display->getSubField<pvd::PVScalar>("limitLow")) {
+            display_low = field->getAs<double>();
+        }
+        if (auto field = display->getSubField<pvd::PVScalar>("limitHigh")) {
+            display_high = field->getAs<double>();
+        }
+    }
+    if (auto control = pstruct.getSubField<pvd::PVStructure>("control")) {
+        if (auto field = control->getSubField<pvd::PVScalar>("limitLow")) {
+            control_low = field->getAs<double>();
+        }
+        if (auto field = control->getSubField<pvd::PVScalar>("limitHigh")) {
+            control_high = field->getAs<double>();
         }
     }
+    if (auto field = pstruct.getSubField<pvd::PVStringArray>("value.choices")) {
+        auto view = field->view();
+        choices = ChoiceTable::intern(std::vector<std::string>(view.begin(), view.end()));
+    }
+}
 
-    if (slots_copy.empty())
+void MonitorSlots::Value::resolve(std::shared_ptr<const pvd::PVStructure> pstruct) {
+    *this = Value();
+    root = std::move(pstruct);
+    field = root->getSubField("value").get();
+    scalar = dynamic_cast<const pvd::PVScalar*>(field);
+    array = dynamic_cast<const pvd::PVScalarArray*>(field);
+    if (auto structure = dynamic_cast<const pvd::PVStructure*>(field)) {
+        enum_index = structure->getSubField<pvd::PVInt>("index").get();
+    }
+    if (!scalar) {
         return;
+    }
+    switch (scalar->getScalar()->getScalarType()) {
+    case pvd::pvByte:
+    case pvd::pvShort:
+    case pvd::pvInt:
+    case pvd::pvLong:
+        kind = Kind::Signed;
+        break;
+    case pvd::pvUByte:
+    case pvd::pvUShort:
+    case pvd::pvUInt:
+    case pvd::pvULong:
+        kind = Kind::Unsigned;
+        break;
+    case pvd::pvFloat:
+    case pvd::pvDouble:
+        kind = Kind::Floating;
+        break;
+    default:
+        break;
+    }
+}
 
-    // Extract data from PVStructure into each slot's type
-    for (auto& [type_id, incoming] : slots_copy) {
-        bool success = false;
-        std::visit(
-            [&](auto& var) {
-                using VarType = std::decay_t<decltype(var)>;
+void MonitorSlots::Value::read() {
+    switch (kind) {
+    case Kind::Signed:
+        int_value = scalar->getAs<pvd::int64>();
+        break;
+    case Kind::Unsigned:
+        uint_value = scalar->getAs<pvd::uint64>();
+        break;
+    case Kind::Floating:
+        double_value = scalar->getAs<double>();
+        break;
+    case Kind::Other:
+        break;
+    }
+}
 
-                if constexpr (std::is_arithmetic_v<VarType>) {
-                    if (auto val_field = pstruct->getSubField<pvd::PVScalar>("value")) {
-                        var = val_field->getAs<VarType>();
-                        success = true;
-                    }
-                }
+bool MonitorSlots::convert(const Value& value, const PVMetadata& metadata, MonitorVar& incoming) {
+    bool success = false;
+    std::visit(
+        [&](auto& var) {
+            using VarType = std::decay_t<decltype(var)>;
 
-                else if constexpr (std::is_same_v<VarType, std::string>) {
-                    if (auto val_field = pstruct->getSubField<pvd::PVString>("value")) {
-                        var = val_field->getAs<std::string>();
-                        success = true;
-                    } else if (auto val_field = pstruct->getSubField<pvd::PVByteArray>("value")) {
-                        auto pbytearr = val_field->view();
-                        var.assign(pbytearr.begin(), pbytearr.end());
-                        success = true;
-                    } else if (auto val_field = pstruct->getSubField("value")) {
-                        std::ostringstream oss;
-                        oss << std::fixed << std::setprecision(get_precision(pstruct));
-                        val_field->dumpValue(oss);
-                        var = oss.str();
+            if constexpr (std::is_arithmetic_v<VarType>) {
+                if (value.kind != Value::Kind::Other) {
+                    var = value.as<VarType>();
+                    success = true;
+                } else if (value.scalar) {
+                    // pvData throws when a string can't be parsed as a number
+                    try {
+                        var = value.scalar->getAs<VarType>();
                         success = true;
+                    } catch (const std::exception&) {
                     }
                 }
+            }
 
-                else if constexpr (std::is_same_v<VarType, PVEnum>) {
-                    auto pchoices = pstruct->getSubField<pvd::PVStringArray>("value.choices");
-                    auto pindex = pstruct->getSubField<pvd::PVInt>("value.index");
-                    if (pchoices && pindex) {
-                        pvd::shared_vector<const std::string> choices = pchoices->view();
-                        size_t index = pindex->getAs<size_t>();
-                        if (choices.size() > index) {
-                            var.index = index;
-                            var.choice = choices.at(index);
-                            var.choices.assign(choices.begin(), choices.end());
-                            success = true;
-                        }
-                    }
+            else if constexpr (std::is_same_v<VarType, std::string>) {
+                if (auto val_field = dynamic_cast<const pvd::PVString*>(value.scalar)) {
+                    var = val_field->get();
+                    success = true;
+                } else if (auto val_field = dynamic_cast<const pvd::PVByteArray*>(value.array)) {
+                    auto pbytearr = val_field->view();
+                    var.assign(pbytearr.begin(), pbytearr.end());
+                    success = true;
+                } else if (value.kind != Value::Kind::Other) {
+                    var = this->format(value, metadata.precision);
+                    success = true;
+                } else if (value.field) {
+                    std::ostringstream oss;
+                    oss << std::fixed << std::setprecision(metadata.precision);
+                    value.field->dumpValue(oss);
+                    var = oss.str();
+                    success = true;
                 }
+            }
 
-                else if constexpr (is_vector_v<VarType>) {
-                    using ElementType = typename VarType::value_type;
-                    using PVDArray = typename pvd_type_map<ElementType>::array_type;
-                    if (auto parr = pstruct->getSubField<PVDArray>("value")) {
-                        auto vec = parr->view();
-                        var.assign(vec.begin(), vec.end());
+            else if constexpr (std::is_same_v<VarType, PVEnum>) {
+                // the labels come from the metadata, which changes far less often than the index
+                if (value.enum_index) {
+                    size_t index = value.enum_index->getAs<size_t>();
+                    if (metadata.choices.size() > index) {
+                        var.index = index;
+                        var.choices = metadata.choices;
                         success = true;
                     }
                 }
+            }
 
-                else {
-                    success = false;
+            else if constexpr (is_array_view_v<VarType>) {
+                // shares the monitor's buffer instead of copying the elements
+                using PVDArray = typename pvd_type_map<typename VarType::value_type>::array_type;
+                if (auto parr = dynamic_cast<const PVDArray*>(value.array)) {
+                    var = VarType(parr->view());
+                    success = true;
                 }
-            },
-            incoming);
+            }
 
-        if (!success) {
-            std::cerr << "Incompatible types for monitor: " << this->channel.name() << "\n";
-            std::abort();
-        }
+            else if constexpr (is_vector_v<VarType>) {
+                using ElementType = typename VarType::value_type;
+                using PVDArray = typename pvd_type_map<ElementType>::array_type;
+                if (auto parr = dynamic_cast<const PVDArray*>(value.array)) {
+                    auto vec = parr->view();
+                    var.assign(vec.begin(), vec.end());
+                    success = true;
+                }
+            }
+
+            else {
+                success = false;
+            }
+        },
+        incoming);
+    return success;
+}
+
+const std::string& MonitorSlots::format(const Value& value, int precision) {
+    uint64_t bits = 0;
+    switch (value.kind) {
+    case Value::Kind::Signed:
+        bits = static_cast<uint64_t>(value.int_value);
+        precision = 0;
+        break;
+    case Value::Kind::Unsigned:
+        bits = value.uint_value;
+        precision = 0;
+        break;
+    default:
+        std::memcpy(&bits, &value.double_value, sizeof(bits));
+        break;
     }
+    const int type = static_cast<int>(value.kind);
+    if (formatted_.type == type && formatted_.bits == bits && formatted_.precision == precision) {
+        return formatted_.text;
+    }
+    formatted_.type = type;
+    formatted_.bits = bits;
+    formatted_.precision = precision;
 
-    // Write updated values back under lock
-    {
-        const std::lock_guard<std::mutex> lock(mutex_);
-        for (auto& [type_id, incoming] : slots_copy) {
-            monitor_slots_[type_id].data = std::move(incoming);
+    // formats into the cached string without temporaries, reusing its capacity
+    char buf[512];
+    std::to_chars_result res{};
+    switch (value.kind) {
+    case Value::Kind::Signed:
+        res = std::to_chars(buf, buf + sizeof(buf), value.int_value);
+        break;
+    case Value::Kind::Unsigned:
+        res = std::to_chars(buf, buf + sizeof(buf), value.uint_value);
+        break;
+    default:
+        res = std::to_chars(buf, buf + sizeof(buf), value.double_value, std::chars_format::fixed, precision);
+        break;
+    }
+    if (res.ec == std::errc()) {
+        formatted_.text.assign(buf, res.ptr);
+    } else {
+        // very large numbers with a high precision don't fit in buf
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(precision) << value.double_value;
+        formatted_.text = oss.str();
+    }
+    return formatted_.text;
+}
+
+std::string MonitorSlots::request(bool with_metadata, bool with_timestamp) const {
+    const uint32_t active = active_.load(std::memory_order_acquire);
+    if (active == 0) {
+        return "";
+    }
+    std::string fields = "value";
+    if (with_metadata) {
+        fields += ",display,control";
+    } else if (active & (1u << slot_index<std::string>())) {
+        // strings are formatted with the precision in display.format
+        fields += ",display";
+    }
+    if (with_timestamp) {
+        fields += ",timeStamp";
+    }
+    return "field(" + fields + ")";
+}
+
+bool MonitorSlots::update(const std::shared_ptr<const pvd::PVStructure>& pstruct,
+                          const PVMetadata& metadata) {
+    const uint32_t active = active_.load(std::memory_order_acquire);
+    Buffer& buffer = buffers_.write_buffer();
+    buffer.failed = 0;
+    // a monitor keeps its structure until the PV's type changes, so the fields are
+    // only looked up by name for the first update of each structure
+    if (pstruct != value_.root) {
+        value_.resolve(pstruct);
+    }
+    value_.read();
+    for (size_t i = 1; i < NUM_SLOTS; i++) {
+        if (active & (1u << i)) {
+            emplace_index(buffer.slots[i], i, std::make_index_sequence<NUM_SLOTS>{});
+            if (!this->convert(value_, metadata, buffer.slots[i])) {
+                buffer.failed |= 1u << i;
+            }
         }
     }
-    new_data_.store(true, std::memory_order_release);
+    buffers_.publish();
+    return buffer.failed == 0;
 }
 
-bool PVHandler::sync() {
-    if (!new_data_.load(std::memory_order_acquire))
+bool MonitorSlots::remove(size_t index, const void* var) {
+    SlotVars& vars = vars_[index];
+    auto it = std::find(vars.begin(), vars.end(), var);
+    if (it != vars.end()) {
+        vars.erase(it);
+    }
+    if (!vars.empty()) {
         return false;
+    }
+    active_.fetch_and(~(1u << index), std::memory_order_release);
+    return true;
+}
 
-    const std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& [type_id, slot] : monitor_slots_) {
-        for (auto& task : slot.tasks) {
-            task(slot.data);
+bool MonitorSlots::sync() {
+    if (!buffers_.update()) {
+        return false;
+    }
+    const Buffer& buffer = buffers_.read_buffer();
+    // failed slots are skipped so their variables keep the last good value
+    const uint32_t copy = active_.load(std::memory_order_acquire) & ~buffer.failed;
+    failed_ = buffer.failed;
+    for (size_t i = 1; i < NUM_SLOTS; i++) {
+        if (copy & (1u << i)) {
+            COPY_SLOT[i](buffer.slots[i], vars_[i]);
         }
     }
+    return true;
+}
+
+void PVHandler::update_monitored_variable(const pvd::PVStructure::const_shared_pointer& pstruct,
+                                          const pvd::BitSet& changed) {
+    if (slots_.empty())
+        return;
+    const bool initial = std::exchange(initial_update_, false);
 
-    new_data_.store(false, std::memory_order_relaxed);
+    // updates which only touch e.g. the alarm or timeStamp leave every slot as it
+    // was, so they are neither converted nor flagged for a redraw
+    const bool metadata_changed = this->update_metadata(pstruct.get(), changed);
+    const auto [value_first, value_last] = value_field_;
+    const pvd::int32 bit = changed.nextSetBit(static_cast<pvd::uint32>(value_first));
+    const bool value_changed = bit >= 0 && static_cast<size_t>(bit) < value_last;
+    if (!metadata_changed && !value_changed) {
+        return;
+    }
+
+    if (tracing_.load(std::memory_order_relaxed)) {
+        slots_.set_trace(this->trace_update(initial));
+    }
+    // a value which doesn't convert, e.g. a string PV monitored as a double, is
+    // published as failed for the widgets to show rather than being fatal
+    if (!slots_.update(pstruct, *metadata_)) {
+        conversion_errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!new_data_.exchange(true, std::memory_order_acq_rel) && dirty_list_) {
+        dirty_list_->push(*this);
+    }
+}
+
+bool PVHandler::update_metadata(const pvd::PVStructure* pstruct, const pvd::BitSet& changed) {
+    // A new structure comes with each (re)started monitor, and its first update sets every field
+    bool stale = pstruct != metadata_root_;
+    if (stale) {
+        metadata_root_ = pstruct;
+        metadata_fields_.clear();
+        metadata_parents_.clear();
+        value_field_ = {0, 0};
+        if (auto field = pstruct->getSubField("value")) {
+            value_field_ = {field->getFieldOffset(), field->getNextFieldOffset()};
+        }
+        timestamp_seconds_ = pstruct->getSubField<pvd::PVLong>("timeStamp.secondsPastEpoch").get();
+        timestamp_nanoseconds_ = pstruct->getSubField<pvd::PVInt>("timeStamp.nanoseconds").get();
+        for (const char* name : {"display", "control", "value.choices"}) {
+            if (auto field = pstruct->getSubField(name)) {
+                metadata_fields_.emplace_back(field->getFieldOffset(), field->getNextFieldOffset());
+            }
+        }
+        // An enum's choices also change when its whole value structure is marked changed
+        if (auto value = pstruct->getSubField<pvd::PVStructure>("value")) {
+            metadata_parents_.push_back(value->getFieldOffset());
+        }
+    }
+    for (size_t i = 0; !stale && i < metadata_fields_.size(); i++) {
+        const auto [first, last] = metadata_fields_[i];
+        const pvd::int32 bit = changed.nextSetBit(static_cast<pvd::uint32>(first));
+        stale = bit >= 0 && static_cast<size_t>(bit) < last;
+    }
+    for (size_t i = 0; !stale && i < metadata_parents_.size(); i++) {
+        stale = changed.get(static_cast<pvd::uint32>(metadata_parents_[i]));
+    }
+    if (!stale && !changed.get(0)) {
+        return false;
+    }
+
+    auto metadata = std::make_shared<PVMetadata>(*metadata_);
+    metadata->update(*pstruct);
+    std::atomic_store(&metadata_, std::shared_ptr<const PVMetadata>(std::move(metadata)));
     return true;
 }
 
+UpdateTrace PVHandler::trace_update(bool initial) const {
+    UpdateTrace trace;
+    trace.received = std::chrono::system_clock::now();
+    // the first update carries the time of the PV's last change, which may be long ago
+    if (initial || !timestamp_seconds_ || timestamp_seconds_->get() <= 0) {
+        return trace;
+    }
+    // EPICS timestamps since the POSIX epoch, like system_clock on every supported platform
+    std::chrono::nanoseconds since_epoch = std::chrono::seconds(timestamp_seconds_->get());
+    if (timestamp_nanoseconds_) {
+        since_epoch += std::chrono::nanoseconds(timestamp_nanoseconds_->get());
+    }
+    trace.source = UpdateTrace::time_point(
+        std::chrono::duration_cast<UpdateTrace::time_point::duration>(since_epoch));
+    return trace;
+}
+
+bool PVHandler::sync() {
+    bool updated = false;
+    if (put_status_changed_.exchange(false, std::memory_order_acq_rel)) {
+        const std::lock_guard<std::mutex> lock(put_mutex_);
+        put_status_ = put_result_;
+        if (puts_in_flight_.load(std::memory_order_acquire) > 0) {
+            put_status_.state = PutStatus::State::Pending;
+        }
+        updated = true;
+    }
+
+    if (new_data_.exchange(false, std::memory_order_acq_rel)) {
+        updated = slots_.sync() || updated;
+    }
+    generation_ += updated;
+    return updated;
+}
+
+void PVHandler::put(const std::string& field, PutValue value, PutPolicy policy) {
+    if (!channel_open_) {
+        put_status_ = {PutStatus::State::Failed, "Not connected, " + name + " is paused"};
+        return;
+    }
+    if (!put_queue_) {
+        put_queue_ = std::make_shared<PutQueue>();
+    }
+    // Count the put before queueing it, since it may complete before put() returns
+    puts_in_flight_.fetch_add(1, std::memory_order_acq_rel);
+    const PutQueue::Result result = put_queue_->put(*this, field, std::move(value), policy);
+    if (result != PutQueue::Result::Queued) {
+        puts_in_flight_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    // a stopped queue never reports back, so the put would stay pending forever
+    if (result == PutQueue::Result::Stopped) {
+        put_status_ = {PutStatus::State::Failed, "Put queue stopped, " + name + " was not written"};
+        return;
+    }
+    put_status_.state = PutStatus::State::Pending;
+}
+
+void PVHandler::put_done(const PutStatus& status) {
+    {
+        const std::lock_guard<std::mutex> lock(put_mutex_);
+        put_result_ = status;
+    }
+    puts_in_flight_.fetch_sub(1, std::memory_order_acq_rel);
+    put_status_changed_.store(true, std::memory_order_release);
+    if (dirty_list_) {
+        dirty_list_->push(*this);
+    }
+}
+
 PVGroup::PVGroup(pvac::ClientProvider& provider, const std::vector<std::string>& pv_names)
-    : provider_(provider) {
+    : dirty_list_(std::make_shared<DirtyList>()), put_queue_(std::make_shared<PutQueue>()),
+      provider_(provider) {
+    this->add(pv_names);
+}
+
+PVGroup::PVGroup(pvac::ClientProvider& provider)
+    : dirty_list_(std::make_shared<DirtyList>()), put_queue_(std::make_shared<PutQueue>()),
+      provider_(provider) {}
+
+PVGroup::~PVGroup() {
+    // The handlers also hold the queue, so stop it before they are destroyed
+    put_queue_->stop();
+}
+
+size_t PVGroup::shard_index(const std::string& pv_name) {
+    return std::hash<std::string>{}(pv_name) % NUM_SHARDS;
+}
+
+std::shared_ptr<PVHandler> PVGroup::find(const std::string& pv_name) const {
+    const auto pvs = std::atomic_load(&shards_[shard_index(pv_name)].pvs);
+    auto it = pvs->find(pv_name);
+    return it != pvs->end() ? it->second : nullptr;
+}
+
+void PVGroup::add(const std::string& pv_name) { this->add(std::vector<std::string>{pv_name}); }
+
+void PVGroup::add(const std::vector<std::string>& pv_names) { this->insert(pv_names, true); }
+
+void PVGroup::insert(const std::vector<std::string>& pv_names, bool pin) {
+    std::array<std::vector<const std::string*>, NUM_SHARDS> by_shard;
     for (const auto& name : pv_names) {
-        this->add(name);
+        if (auto pv = this->find(name)) {
+            if (pin) {
+                this->pin(*pv);
+            }
+        } else {
+            by_shard[shard_index(name)].push_back(&name);
+        }
+    }
+    for (size_t i = 0; i < NUM_SHARDS; i++) {
+        if (by_shard[i].empty()) {
+            continue;
+        }
+        // Connecting calls into the client, so the handlers are created before taking
+        // the lock. PVs added for a Subscription wait for it to be activated before connecting
+        std::vector<std::shared_ptr<PVHandler>> created;
+        created.reserve(by_shard[i].size());
+        for (const std::string* name : by_shard[i]) {
+            created.push_back(std::make_shared<PVHandler>(provider_, *name, dirty_list_, put_queue_, !pin));
+            created.back()->pinned_.store(pin, std::memory_order_relaxed);
+        }
+
+        std::vector<std::shared_ptr<PVHandler>> unused;
+        {
+            Shard& shard = shards_[i];
+            std::lock_guard<std::mutex> lock(shard.write_mutex);
+            auto pvs = std::make_shared<PVMap>(*shard.pvs);
+            for (auto& pv : created) {
+                // another thread may have added it since the check above
+                auto [it, inserted] = pvs->emplace(pv->name, pv);
+                if (!inserted) {
+                    if (pin) {
+                        this->pin(*it->second);
+                    }
+                    unused.push_back(std::move(pv));
+                }
+            }
+            std::atomic_store(&shard.pvs, std::shared_ptr<const PVMap>(std::move(pvs)));
+        }
+        for (const auto& pv : unused) {
+            this->retire(pv);
+        }
+        // checked after publishing, so trace_latency() either finds the new PVs or is seen here
+        if (tracing_.load()) {
+            for (const auto& pv : created) {
+                // the handlers moved to unused are null
+                if (pv) {
+                    pv->trace_latency();
+                }
+            }
+        }
     }
 }
 
-PVGroup::PVGroup(pvac::ClientProvider& provider) : provider_(provider) {}
+void PVGroup::prepare(const std::vector<std::string>& pv_names) { this->insert(pv_names, false); }
+
+/**
+ * @brief Shared state of the copies of a Subscription.
+ */
+struct Subscription::Token {
+    Token(PVGroup& group, std::shared_ptr<PVHandler> pv, size_t slot, const void* var)
+        : group(group), pv(std::move(pv)), slot(slot), var(var) {}
+
+    Token(const Token&) = delete;
+    Token& operator=(const Token&) = delete;
+
+    ~Token() { group.release(*this); }
 
-void PVGroup::add(const std::string& pv_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!pv_map.count(pv_name)) {
-        pv_map.emplace(pv_name, std::make_shared<PVHandler>(provider_, pv_name));
+    void set_active(bool value) { group.set_active(*this, value); }
+
+    PVGroup& group;                ///< Group the PV belongs to.
+    std::shared_ptr<PVHandler> pv; ///< The subscribed PV.
+    size_t slot;                   ///< Slot index of var.
+    const void* var;               ///< Monitored variable, or null for acquire().
+    bool active = false;           ///< Whether counted in pv->active_users_.
+};
+
+void Subscription::set_active(bool active) {
+    if (token_) {
+        token_->set_active(active);
     }
 }
 
-PVHandler& PVGroup::get_pv(const std::string& pv_name) {
-    auto it = pv_map.find(pv_name);
-    if (it == pv_map.end()) {
-        throw std::runtime_error(pv_name + " not registered in PVGroup");
+bool Subscription::active() const { return token_ && token_->active; }
+
+size_t Subscription::slot() const { return token_ && token_->var ? token_->slot : 0; }
+
+Subscription PVGroup::acquire(const std::string& pv_name) {
+    this->insert({pv_name}, false);
+    return this->make_subscription(pv_name, 0, nullptr);
+}
+
+Subscription PVGroup::make_subscription(const std::string& pv_name, size_t slot, void* var, bool automatic) {
+    auto pv = this->get_pv_shared(pv_name);
+    pv->users_.fetch_add(1, std::memory_order_relaxed);
+    Subscription sub(std::make_shared<Subscription::Token>(*this, std::move(pv), slot, var));
+    if (!automatic) {
+        return sub;
+    } else if (capture_) {
+        capture_->push_back(sub);
+    } else {
+        this->set_active(*sub.token_, true);
+    }
+    return sub;
+}
+
+void PVGroup::set_active(Subscription::Token& token, bool active) {
+    if (token.active == active) {
+        return;
+    }
+    token.active = active;
+    PVHandler& pv = *token.pv;
+    if (active && pv.active_users_++ == 0) {
+        pv.resume();
+    } else if (!active && --pv.active_users_ == 0 && !pv.pinned_.load(std::memory_order_relaxed)) {
+        pv.pause();
+    }
+}
+
+void PVGroup::pin(PVHandler& pv) {
+    pv.pinned_.store(true, std::memory_order_relaxed);
+    pv.resume();
+}
+
+void PVGroup::release(Subscription::Token& token) {
+    const auto& pv = token.pv;
+    this->set_active(token, false);
+    if (token.var) {
+        pv->unset_monitor(token.slot, token.var);
+    }
+    if (pv->users_.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+        !pv->pinned_.load(std::memory_order_relaxed)) {
+        this->retire(pv);
+    }
+}
+
+void PVGroup::begin_capture(std::vector<Subscription>& subscriptions) {
+    capture_ = &subscriptions;
+    pending_.push_back(&subscriptions);
+}
+
+void PVGroup::stop_capture(std::vector<Subscription>& subscriptions) {
+    if (capture_ == &subscriptions) {
+        capture_ = nullptr;
+    }
+}
+
+void PVGroup::end_capture(std::vector<Subscription>& subscriptions, bool activate) {
+    this->stop_capture(subscriptions);
+    auto it = std::find(pending_.begin(), pending_.end(), &subscriptions);
+    if (it == pending_.end()) {
+        return;
+    }
+    pending_.erase(it);
+    if (activate) {
+        for (Subscription& sub : subscriptions) {
+            sub.set_active(true);
+        }
     }
-    return *it->second;
 }
 
+bool PVGroup::remove(const std::string& pv_name) {
+    auto pv = this->find(pv_name);
+    if (!pv) {
+        return false;
+    }
+    this->retire(pv);
+    return true;
+}
+
+void PVGroup::retire(const std::shared_ptr<PVHandler>& pv) {
+    {
+        Shard& shard = shards_[shard_index(pv->name)];
+        std::lock_guard<std::mutex> lock(shard.write_mutex);
+        // the name may already map to a newer handler after an earlier remove()
+        auto it = shard.pvs->find(pv->name);
+        if (it != shard.pvs->end() && it->second == pv) {
+            auto pvs = std::make_shared<PVMap>(*shard.pvs);
+            pvs->erase(pv->name);
+            std::atomic_store(&shard.pvs, std::shared_ptr<const PVMap>(std::move(pvs)));
+        }
+    }
+    if (!pv->closed_) {
+        pv->close();
+    }
+
+    // The dirty list and the put queue hold raw pointers to the handler,
+    // so it is only freed by sync() once neither can reach it
+    const std::lock_guard<std::mutex> lock(retired_mutex_);
+    retired_.push_back(pv);
+    has_retired_.store(true, std::memory_order_release);
+}
+
+void PVGroup::free_retired() {
+    std::vector<std::shared_ptr<PVHandler>> freed;
+    {
+        const std::lock_guard<std::mutex> lock(retired_mutex_);
+        auto first_freed = std::stable_partition(retired_.begin(), retired_.end(), [this](const auto& pv) {
+            // a put completing pushes the handler before put_queue_ lets go of it
+            return !put_queue_->idle(*pv) || pv->dirty_queued_.load(std::memory_order_acquire);
+        });
+        std::move(first_freed, retired_.end(), std::back_inserter(freed));
+        retired_.erase(first_freed, retired_.end());
+        has_retired_.store(!retired_.empty(), std::memory_order_release);
+    }
+    // a handler still held by a Subscription is retired again when that is released
+    freed.clear();
+}
+
+PVHandler& PVGroup::get_pv(const std::string& pv_name) { return *this->get_pv_shared(pv_name); }
+
 std::shared_ptr<PVHandler> PVGroup::get_pv_shared(const std::string& pv_name) {
-    auto it = pv_map.find(pv_name);
-    if (it == pv_map.end()) {
+    auto pv = this->find(pv_name);
+    if (!pv) {
         throw std::runtime_error(pv_name + " not registered in PVGroup");
     }
-    return it->second;
+    return pv;
 }
 
 PVHandler& PVGroup::operator[](const std::string& pv_name) { return this->get_pv(pv_name); }
 
 bool PVGroup::sync() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const auto start = std::chrono::steady_clock::now();
+    const bool tracing = tracing_.load(std::memory_order_relaxed);
+    const auto synced = tracing ? std::chrono::system_clock::now() : UpdateTrace::time_point{};
+
+    // Displays constructed since the last sync() start out active
+    if (!pending_.empty()) {
+        capture_ = nullptr;
+        auto pending = std::move(pending_);
+        pending_.clear();
+        for (auto* subscriptions : pending) {
+            for (Subscription& sub : *subscriptions) {
+                sub.set_active(true);
+            }
+        }
+    }
+
     bool new_data = false;
-    for (auto& [name, pv] : pv_map) {
+    size_t visited = 0;
+    PVHandler* pv = dirty_list_->take_all();
+    while (pv) {
+        // Read the link before clearing the flag, after which the
+        // monitor thread may push this handler again.
+        PVHandler* next = pv->dirty_next_;
+        pv->dirty_queued_.store(false, std::memory_order_release);
         if (pv->sync()) {
             new_data = true;
+            if (tracing) {
+                this->trace_synced(*pv, synced);
+            }
         }
+        pv = next;
+        visited++;
     }
+    if (has_retired_.load(std::memory_order_acquire)) {
+        this->free_retired();
+    }
+    last_sync_pvs_.store(visited, std::memory_order_relaxed);
+    sync_time_.record(std::chrono::steady_clock::now() - start);
     return new_data;
 }
+
+size_t PVGroup::conversion_errors() const {
+    size_t total = 0;
+    for (const Shard& shard : shards_) {
+        for (const auto& [name, pv] : *std::atomic_load(&shard.pvs)) {
+            total += pv->conversion_errors();
+        }
+    }
+    return total;
+}
+
+size_t PVGroup::dropped_updates() const {
+    size_t total = 0;
+    for (const Shard& shard : shards_) {
+        for (const auto& [name, pv] : *std::atomic_load(&shard.pvs)) {
+            total += pv->dropped_updates();
+        }
+    }
+    return total;
+}
+
+std::vector<PVMetrics> PVGroup::pv_metrics() const {
+    std::vector<PVMetrics> out;
+    for (const Shard& shard : shards_) {
+        for (const auto& [name, pv] : *std::atomic_load(&shard.pvs)) {
+            PVMetrics m;
+            m.name = name;
+            m.connected = pv->connected();
+            m.monitor_events = pv->monitor_events();
+            m.dropped_updates = pv->dropped_updates();
+            m.conversion_errors = pv->conversion_errors();
+            m.latency = pv->latency();
+            out.push_back(std::move(m));
+        }
+    }
+    return out;
+}
+
+void PVGroup::trace_latency() {
+    if (tracing_.exchange(true)) {
+        return;
+    }
+    for (const Shard& shard : shards_) {
+        for (const auto& [name, pv] : *std::atomic_load(&shard.pvs)) {
+            pv->trace_latency();
+        }
+    }
+}
+
+void PVGroup::trace_to_file(const std::string& path) {
+    trace_writer_ = std::make_unique<TraceWriter>(path);
+    this->trace_latency();
+}
+
+void PVGroup::trace_synced(PVHandler& pv, UpdateTrace::time_point now) {
+    // sync() also returns true for a completed put, which leaves the values as they were
+    const UpdateTrace& trace = pv.slots_.trace();
+    if (trace.received == UpdateTrace::time_point{} || trace.received == pv.last_traced_) {
+        return;
+    }
+    pv.last_traced_ = trace.received;
+    latency_.callback_to_sync.record(now - trace.received);
+    if (trace.source != UpdateTrace::time_point{}) {
+        latency_.source_to_callback.record(trace.received - trace.source);
+    }
+    auto latency = std::atomic_load(&pv.latency_);
+    if (latency && pending_traces_.size() < MAX_PENDING_TRACES) {
+        pending_traces_.push_back({std::move(latency), {trace.source, trace.received, now}});
+    }
+}
+
+void PVGroup::frame_drawn() {
+    if (pending_traces_.empty()) {
+        return;
+    }
+    const auto now = std::chrono::system_clock::now();
+    for (const PendingTrace& pending : pending_traces_) {
+        const UpdateTrace& trace = pending.trace;
+        latency_.sync_to_paint.record(now - trace.synced);
+        if (trace.source != UpdateTrace::time_point{}) {
+            latency_.source_to_paint.record(now - trace.source);
+            pending.pv->source_to_paint.record(now - trace.source);
+        }
+        if (trace_writer_) {
+            trace_writer_->write(pending.pv->name, trace, now);
+        }
+    }
+    pending_traces_.clear();
+}
+
+void PVGroup::wait_for_data() { dirty_list_->wait(); }
+
+bool PVGroup::wait_for_data(std::chrono::milliseconds timeout) { return dirty_list_->wait_for(timeout); }
+
+void PVGroup::wake() { dirty_list_->notify(); }
 } // namespace pvtui
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <type_traits>
 #include <string>
-#include <typeindex>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -13,15 +17,163 @@
 #include <pv/caProvider.h>
 #include <pva/client.h>
 
+#include <pvtui/metrics.hpp>
+#include <pvtui/put_queue.hpp>
+
 namespace pvtui {
 
+/**
+ * @brief An immutable, reference-counted list of enum labels.
+ *
+ * Tables created with intern() are shared by every PV with the same labels, so
+ * copying a ChoiceTable or a PVEnum never copies the strings.
+ */
+class ChoiceTable {
+  public:
+    /**
+     * @brief Constructs an empty table.
+     */
+    ChoiceTable();
+
+    /**
+     * @brief Gets the shared table holding the given labels, creating it if needed.
+     * @param labels The enum labels.
+     * @return A ChoiceTable which compares equal to every other table interned with the same labels.
+     */
+    static ChoiceTable intern(std::vector<std::string> labels);
+
+    ChoiceTable(const ChoiceTable& other) = default;
+    ChoiceTable(ChoiceTable&& other) noexcept = default;
+    ChoiceTable& operator=(ChoiceTable&& other) noexcept = default;
+
+    /**
+     * @brief Shares another table's labels, skipping the reference count update if they already match.
+     * @param other The table to copy.
+     * @return A reference to this table.
+     */
+    ChoiceTable& operator=(const ChoiceTable& other) {
+        if (labels_ != other.labels_) {
+            labels_ = other.labels_;
+        }
+        return *this;
+    }
+
+    /// @brief Gets the number of labels.
+    size_t size() const { return labels_->size(); }
+
+    /// @brief Checks if there are no labels.
+    bool empty() const { return labels_->empty(); }
+
+    /// @brief Gets the label at index i, which must be less than size().
+    const std::string& operator[](size_t i) const { return (*labels_)[i]; }
+
+    /// @brief Gets an iterator to the first label.
+    std::vector<std::string>::const_iterator begin() const { return labels_->begin(); }
+
+    /// @brief Gets an iterator past the last label.
+    std::vector<std::string>::const_iterator end() const { return labels_->end(); }
+
+    /// @brief Gets the underlying vector of labels.
+    const std::vector<std::string>& labels() const { return *labels_; }
+
+    /// @brief Checks if two tables share the same storage.
+    bool operator==(const ChoiceTable& other) const { return labels_ == other.labels_; }
+
+    /// @brief Checks if two tables use different storage.
+    bool operator!=(const ChoiceTable& other) const { return labels_ != other.labels_; }
+
+  private:
+    explicit ChoiceTable(std::shared_ptr<const std::vector<std::string>> labels);
+
+    std::shared_ptr<const std::vector<std::string>> labels_; ///< Never null.
+};
+
 /**
  * @brief Represents the state of an EPICS enumeration (e.g., mbbo/mbbi).
+ *
+ * An index change only stores the new index; the labels are a shared ChoiceTable
+ * which is replaced only when the server's labels change.
  */
 struct PVEnum {
-    int index = 0;                    ///< The current integer index of the selected choice.
-    std::vector<std::string> choices; ///< The list of all available string choices for the enum.
-    std::string choice = "";          ///< The string value of the currently selected choice.
+    int index = 0;       ///< The current integer index of the selected choice.
+    ChoiceTable choices; ///< The list of all available string choices for the enum.
+
+    /**
+     * @brief Gets the string value of the currently selected choice.
+     * @return The label at index, or an empty string if index is out of range.
+     */
+    const std::string& choice() const;
+};
+
+/**
+ * @brief Display metadata of a PV, parsed from its display, control and enum fields.
+ *
+ * Fields which the PV's monitor does not carry keep their defaults.
+ */
+struct PVMetadata {
+    int precision = 4;                ///< Digits after the decimal point when formatting as a string.
+    std::string units;                ///< Engineering units from display.units.
+    double display_low = 0.0;         ///< Lower display limit from display.limitLow.
+    double display_high = 0.0;        ///< Upper display limit from display.limitHigh.
+    double control_low = 0.0;         ///< Lower control limit from control.limitLow.
+    double control_high = 0.0;        ///< Upper control limit from control.limitHigh.
+    ChoiceTable choices;              ///< Enum labels from value.choices.
+
+    /**
+     * @brief Reads the metadata fields present in a PVStructure.
+     * @param pstruct The PV's top level structure.
+     */
+    void update(const epics::pvData::PVStructure& pstruct);
+};
+
+/**
+ * @brief Read-only view of an array PV's value which shares the monitor's buffer.
+ *
+ * pvData never modifies an array after it is published, so a view stays valid
+ * and unchanged when later updates replace the PV's value, and copying a view
+ * only copies a reference. Use it instead of std::vector<T> for large waveforms
+ * to avoid copying every element on each update.
+ * @tparam T The element type.
+ */
+template <typename T>
+class ArrayView {
+  public:
+    using value_type = T; ///< The element type.
+
+    /**
+     * @brief Constructs an empty view.
+     */
+    ArrayView() = default;
+
+    /**
+     * @brief Constructs a view sharing a pvData array.
+     * @param data The array, e.g. from PVScalarArray::view().
+     */
+    explicit ArrayView(epics::pvData::shared_vector<const T> data) : data_(std::move(data)) {}
+
+    /// @brief Gets the number of elements.
+    size_t size() const { return data_.size(); }
+
+    /// @brief Checks if there are no elements.
+    bool empty() const { return data_.empty(); }
+
+    /// @brief Gets the element at index i, which must be less than size().
+    const T& operator[](size_t i) const { return data_[i]; }
+
+    /// @brief Gets a pointer to the first element.
+    const T* data() const { return data_.data(); }
+
+    /// @brief Gets an iterator to the first element.
+    const T* begin() const { return data_.data(); }
+
+    /// @brief Gets an iterator past the last element.
+    const T* end() const { return data_.data() + data_.size(); }
+
+    /// @brief Gets the underlying pvData array.
+    const epics::pvData::shared_vector<const T>& shared() const { return data_; }
+
+  private:
+    epics::pvData::shared_vector<const T> data_; ///< Shared, immutable elements.
 };
 
 /**
@@ -30,7 +182,262 @@ struct PVEnum {
  * This allows a single mechanism to update variables of different types.
  */
 using MonitorVar = std::variant<std::monostate, std::string, int, double, std::vector<std::string>,
-                                std::vector<int>, std::vector<double>, PVEnum>;
+                                std::vector<int>, std::vector<double>, PVEnum, ArrayView<int>,
+                                ArrayView<double>>;
+
+/**
+ * @brief Wait-free single-producer/single-consumer triple buffer.
+ *
+ * The producer fills write_buffer() and calls publish(); the consumer calls
+ * update() to take the newest published buffer and reads it with read_buffer().
+ * Neither side ever blocks the other, and intermediate values the consumer did not
+ * pick up are overwritten. Each of the three buffers is reused, so types like
+ * std::string and std::vector keep their capacity.
+ * @tparam T The buffered type.
+ */
+template <typename T>
+class TripleBuffer {
+  public:
+    /**
+     * @brief Gets the buffer owned by the producer.
+     * @return A reference to the buffer to fill before calling publish().
+     */
+    T& write_buffer() { return buffers_[back_]; }
+
+    /**
+     * @brief Makes the current write buffer the newest value for the consumer.
+     */
+    void publish() { back_ = state_.exchange(back_ | DIRTY, std::memory_order_acq_rel) & INDEX_MASK; }
+
+    /**
+     * @brief Takes the newest published buffer, if any.
+     * @return True if a new buffer was published since the last call, false otherwise.
+     */
+    bool update() {
+        if (!(state_.load(std::memory_order_relaxed) & DIRTY)) {
+            return false;
+        }
+        front_ = state_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    /**
+     * @brief Gets the buffer owned by the consumer.
+     * @return A reference to the buffer taken by the last successful update().
+     */
+    const T& read_buffer() const { return buffers_[front_]; }
+
+  private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t DIRTY = 0x4;
+
+    T buffers_[3];                   ///< Back, middle, and front buffers.
+    uint8_t back_ = 0;               ///< Index of the producer's buffer.
+    uint8_t front_ = 1;              ///< Index of the consumer's buffer.
+    std::atomic<uint8_t> state_ = 2; ///< Index of the middle buffer plus the DIRTY flag.
+};
+
+/**
+ * @brief Typed storage for the values a PV delivers to user variables.
+ *
+ * Holds one MonitorVar per registered type, indexed by the type's position in the
+ * MonitorVar variant, along with the addresses of the user variables it is copied
+ * to. Since a slot's index fixes its type, sync() copies each slot through one
+ * typed loop with no per-subscriber callback or allocation. The
+ * monitor callback thread converts each update in place into a triple buffer of
+ * slots and publishes it, and sync() picks up the newest complete set of values, so
+ * the producer never waits on the UI thread and a steady-state update allocates
+ * nothing. The value field is looked up and numbers are read once per update for
+ * all slots, and a number formatted for the string slot is reused until it changes.
+ */
+class MonitorSlots {
+  public:
+    /// @brief Number of alternatives in MonitorVar, and therefore of slots.
+    static constexpr size_t NUM_SLOTS = std::variant_size_v<MonitorVar>;
+
+    /**
+     * @brief Registers a variable to be updated by sync() with values of type T.
+     *
+     * Must be called from the thread that calls sync().
+     * @tparam T The type of the variable to monitor.
+     * @param var A reference to the variable that will be updated.
+     * @return True if T was not monitored before, false if another variable already uses its slot.
+     */
+    template <typename T>
+    bool add(T& var) {
+        constexpr size_t index = slot_index<T>();
+        vars_[index].push_back(&var);
+        const uint32_t prev = active_.fetch_or(1u << index, std::memory_order_release);
+        return !(prev & (1u << index));
+    }
+
+    /**
+     * @brief Unregisters a variable added with add().
+     *
+     * Must be called from the thread that calls sync().
+     * @param index The variable's slot, slot_index<T>() for a variable of type T.
+     * @param var The address of the variable.
+     * @return True if no other variable uses the slot, false otherwise.
+     */
+    bool remove(size_t index, const void* var);
+
+    /// @brief Gets the position of T in MonitorVar at compile time.
+    template <typename T, size_t I = 0>
+    static constexpr size_t slot_index() {
+        static_assert(I < NUM_SLOTS, "Type is not an alternative of pvtui::MonitorVar");
+        if constexpr (std::is_same_v<T, std::variant_alternative_t<I, MonitorVar>>) {
+            return I;
+        } else {
+            return slot_index<T, I + 1>();
+        }
+    }
+
+    /**
+     * @brief Checks if no variables have been registered.
+     * @return True if there are no slots, false otherwise.
+     */
+    bool empty() const { return active_.load(std::memory_order_acquire) == 0; }
+
+    /**
+     * @brief Builds the pvRequest string for the fields needed to fill the registered slots.
+     * @param with_metadata Whether to also request display and control for PVMetadata.
+     * @param with_timestamp Whether to also request timeStamp for latency tracing.
+     * @return "field(value)", with display added when a string slot needs the display format,
+     * or an empty string if there are no slots.
+     */
+    std::string request(bool with_metadata = false, bool with_timestamp = false) const;
+
+    /**
+     * @brief Converts the value in a PVStructure into every slot and publishes it.
+     *
+     * Must only be called from a single producer thread.
+     * @param pstruct The PVStructure containing the new data. Its fields are looked up
+     * when it differs from the previous update's structure and reused otherwise.
+     * @param metadata The PV's metadata, used to format numbers as strings.
+     * @return False if any slot could not be converted from the PV's type. Such slots
+     * are published as failed and the other slots are still updated.
+     */
+    bool update(const std::shared_ptr<const epics::pvData::PVStructure>& pstruct, const PVMetadata& metadata);
+
+    /**
+     * @brief Copies the newest published slot values to the registered user variables.
+     * @return True if a new set of values was published since the last call.
+     */
+    bool sync();
+
+    /**
+     * @brief Attaches a trace to the values the next update() publishes.
+     *
+     * Must only be called from the producer thread, before update().
+     * @param trace The stages the update has passed so far.
+     */
+    void set_trace(const UpdateTrace& trace) { buffers_.write_buffer().trace = trace; }
+
+    /**
+     * @brief Gets the trace attached to the values picked up by sync().
+     * @return The trace, with zero times if the update was not traced.
+     */
+    const UpdateTrace& trace() const { return buffers_.read_buffer().trace; }
+
+    /**
+     * @brief Checks if any slot could not be converted from the update picked up by sync().
+     *
+     * Variables of a failed slot keep their last good value.
+     * @return True if the PV's value does not convert to one of the monitored types.
+     */
+    bool failed() const { return failed_ != 0; }
+
+    /**
+     * @brief Checks if one slot could not be converted from the update picked up by sync().
+     * @param index The slot, slot_index<T>() for a variable of type T.
+     * @return True if the PV's value does not convert to the slot's type.
+     */
+    bool failed(size_t index) const { return failed_ & (1u << index); }
+
+  private:
+    using SlotArray = std::array<MonitorVar, NUM_SLOTS>;
+
+    /// @brief One update's slot values, handed from the producer to sync().
+    struct Buffer {
+        SlotArray slots;     ///< Converted values, indexed like MonitorVar.
+        uint32_t failed = 0; ///< Bit i set when slot i could not be converted.
+        UpdateTrace trace;   ///< Set by set_trace() while latency tracing.
+    };
+
+    /// @brief User variables of a slot. Entries in slot i point to the i-th MonitorVar alternative.
+    using SlotVars = std::vector<void*>;
+
+    /**
+     * @brief Typed pointers to the value field of a monitored structure, shared by every slot.
+     *
+     * resolve() looks the fields up by name once per structure, and read() loads a
+     * numeric scalar into the number matching its kind on each update.
+     */
+    struct Value {
+        enum class Kind { Other, Signed, Unsigned, Floating };
+
+        /// @brief Looks up the fields of a new structure, which is kept alive while they are used.
+        void resolve(std::shared_ptr<const epics::pvData::PVStructure> pstruct);
+
+        /// @brief Reads the current number of a numeric scalar.
+        void read();
+
+        /// @brief Converts the number to T the way PVScalar::getAs<T>() does.
+        template <typename T>
+        T as() const {
+            switch (kind) {
+            case Kind::Signed:
+                return static_cast<T>(int_value);
+            case Kind::Unsigned:
+                return static_cast<T>(uint_value);
+            default:
+                return static_cast<T>(double_value);
+            }
+        }
+
+        std::shared_ptr<const epics::pvData::PVStructure> root; ///< Structure the pointers point into.
+        const epics::pvData::PVField* field = nullptr;          ///< value, null if there is none.
+        const epics::pvData::PVScalar* scalar = nullptr;        ///< value if it is a scalar.
+        const epics::pvData::PVScalarArray* array = nullptr;    ///< value if it is a scalar array.
+        const epics::pvData::PVInt* enum_index = nullptr;       ///< value.index if value is an enum.
+        Kind kind = Kind::Other;                                ///< Other unless scalar is a number.
+        epics::pvData::int64 int_value = 0;                     ///< The number of a Signed scalar.
+        epics::pvData::uint64 uint_value = 0;                   ///< The number of an Unsigned scalar.
+        double double_value = 0.0;                              ///< The number of a Floating scalar.
+    };
+
+    /// @brief A number formatted for the string slot, kept until the number or precision changes.
+    struct FormattedNumber {
+        int type = -1;      ///< Kind of number, -1 before the first one.
+        uint64_t bits = 0;  ///< The number's raw bits.
+        int precision = 0;  ///< Digits after the decimal point it was formatted with.
+        std::string text;   ///< The formatted number.
+    };
+
+    /**
+     * @brief Converts a resolved value into a slot, assigning into its existing storage.
+     * @param value The update's value field.
+     * @param metadata The PV's metadata, used to format numbers as strings.
+     * @param var The slot, already holding the alternative to convert to.
+     * @return False if the value does not convert to the slot's type.
+     */
+    bool convert(const Value& value, const PVMetadata& metadata, MonitorVar& var);
+
+    /**
+     * @brief Formats a numeric value, reusing the previous text if the number is unchanged.
+     * @param value The update's value field, which must be numeric.
+     * @param precision Digits after the decimal point for floating point numbers.
+     * @return The formatted number, valid until the next call.
+     */
+    const std::string& format(const Value& value, int precision);
+
+    std::atomic<uint32_t> active_ = 0;     ///< Bit i set when slot i has subscribers.
+    TripleBuffer<Buffer> buffers_;         ///< Slot values handed from the producer to sync().
+    std::array<SlotVars, NUM_SLOTS> vars_; ///< User variables to copy each slot to.
+    uint32_t failed_ = 0;                  ///< Failed slots of the buffer taken by sync().
+    Value value_;                          ///< Producer side fields of the last update's structure.
+    FormattedNumber formatted_;            ///< Producer side cache for format().
+};
 
 /**
  * @brief Monitors a pvac::ClientChannel's connection status.
@@ -63,6 +470,55 @@ class ConnectionMonitor : public pvac::ClientChannel::ConnectCallback {
     std::atomic<bool> connected_{false}; ///< Connection status flag.
 };
 
+struct PVHandler;
+
+/**
+ * @brief Lock-free multi-producer, single-consumer list of PVHandlers with new data.
+ *
+ * Monitor callback threads push a handler when it receives data, and the thread
+ * calling PVGroup::sync() takes the whole list at once, so syncing visits only the
+ * PVs which changed. Each handler is in the list at most once. When the list goes
+ * from empty to non-empty, any thread blocked in wait() is woken.
+ */
+class DirtyList {
+  public:
+    /**
+     * @brief Adds a handler to the list unless it is already queued.
+     * @param pv The handler with new data.
+     */
+    void push(PVHandler& pv);
+
+    /**
+     * @brief Blocks until a handler is pushed onto an empty list or notify() is called.
+     */
+    void wait();
+
+    /**
+     * @brief Blocks until a handler is pushed onto an empty list, notify() is called,
+     * or the timeout expires.
+     * @param timeout Maximum time to wait.
+     * @return True if woken, false on timeout.
+     */
+    bool wait_for(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Wakes a thread blocked in wait() or wait_for().
+     */
+    void notify();
+
+    /**
+     * @brief Removes every queued handler from the list.
+     * @return The first handler, linked through PVHandler::dirty_next_, or nullptr if empty.
+     */
+    PVHandler* take_all();
+
+  private:
+    std::atomic<PVHandler*> head_ = nullptr; ///< Most recently pushed handler.
+    std::mutex wait_mutex_;                  ///< Protects signaled_.
+    std::condition_variable wait_cv_;        ///< Signals waiting threads.
+    bool signaled_ = false;                  ///< Set by notify(), cleared by wait().
+};
+
 /**
  * @brief Manages a single EPICS Process Variable (PV).
  *
@@ -77,8 +533,13 @@ struct PVHandler : public pvac::ClientChannel::MonitorCallback {
      * @brief Constructs a PVHandler.
      * @param provider PVA client provider.
      * @param pv_name Name of the process variable.
+     * @param dirty_list Optional list the handler adds itself to when it receives new data.
+     * @param put_queue Optional queue used by put(). If null, one is created on the first put.
+     * @param paused If true, the channel is not connected until the PVGroup resumes the handler.
      */
-    PVHandler(pvac::ClientProvider& provider, const std::string& pv_name);
+    PVHandler(pvac::ClientProvider& provider, const std::string& pv_name,
+              std::shared_ptr<DirtyList> dirty_list = nullptr, std::shared_ptr<PutQueue> put_queue = nullptr,
+              bool paused = false);
 
     /**
      * @brief Checks if the PV channel is connected.
@@ -88,29 +549,132 @@ struct PVHandler : public pvac::ClientChannel::MonitorCallback {
 
     /**
      * @brief Safely copies the internal monitored value to the user variable.
-     * @return True if new data is available, false otherwise.
+     *
+     * Also publishes the result of any puts completed since the last call to put_status().
+     * @return True if new data or a new put status is available, false otherwise.
      */
     bool sync();
 
+    /**
+     * @brief Gets a counter incremented by each sync() which returns true.
+     *
+     * Must be called from the thread that calls sync(). Renderers compare it with a
+     * value they saved to find out whether anything about the PV has changed since.
+     * @return The number of updating syncs so far.
+     */
+    uint64_t generation() const { return generation_; }
+
+    /**
+     * @brief Writes a value to a field of the PV without blocking.
+     *
+     * The put is issued by the PutQueue on a worker thread, and its result is
+     * available from put_status() after a later sync().
+     * @param field The field to write, e.g. "value". Enum fields are written through their index.
+     * @param value The value to write, converted to the field's type by the server side.
+     * @param policy How to combine the put with earlier puts still waiting to be sent.
+     */
+    void put(const std::string& field, PutValue value, PutPolicy policy = PutPolicy::LastValue);
+
+    /**
+     * @brief Gets the status of the puts issued with put().
+     * @return Pending while any put is in flight, otherwise the outcome of the last one.
+     */
+    const PutStatus& put_status() const { return put_status_; }
+
+    /**
+     * @brief Checks if the PV's value could not be converted to a monitored type.
+     *
+     * Such a PV, e.g. a string PV monitored as a double, keeps its variables at their
+     * last good value instead of stopping the program.
+     * @return True if the update published by the last sync() failed to convert.
+     */
+    bool conversion_failed() const { return slots_.failed(); }
+
+    /**
+     * @brief Checks if the PV's value could not be converted to the type of one slot.
+     *
+     * Unlike conversion_failed(), a variable which converts fine is not reported
+     * as failed because another type monitored on the same PV fails.
+     * @param slot The slot of the variable, see Subscription::slot().
+     * @return True if the update published by the last sync() failed to convert to the slot's type.
+     */
+    bool conversion_failed(size_t slot) const { return slots_.failed(slot); }
+
+    /**
+     * @brief Gets the number of monitor updates that failed to convert. Safe to call from any thread.
+     * @return The total number of failed updates.
+     */
+    size_t conversion_errors() const { return conversion_errors_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets the number of monitor updates skipped because a newer one was already queued.
+     *
+     * Safe to call from any thread. Bursts like a fast motor move or a gateway
+     * flushing its queue on reconnect show up here instead of as conversion work.
+     * @return The total number of dropped updates.
+     */
+    size_t dropped_updates() const { return dropped_updates_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets the number of monitor updates received, including dropped ones.
+     *
+     * Safe to call from any thread.
+     * @return The total number of updates taken from the monitor queue.
+     */
+    uint64_t monitor_events() const { return monitor_events_.load(std::memory_order_relaxed); }
+
     /**
      * @brief Registers a variable to be updated when the PV monitor receives new data and sync() is called.
+     *
+     * The monitor is only subscribed once a variable is registered, and only to the
+     * fields the registered types need. Registering a new type restarts it so the
+     * new variable receives the current value.
      * @tparam T The type of the variable to monitor.
      * @param var A reference to the variable that will be updated.
      */
     template <typename T>
     void set_monitor(T& var) {
-        auto key = std::type_index(typeid(T));
-        auto& slot = monitor_slots_[key];
-        if (std::holds_alternative<std::monostate>(slot.data)) {
-            slot.data = T{};
+        if (slots_.add(var)) {
+            this->restart_monitor();
         }
-        slot.tasks.push_back([&var](const MonitorVar& latest_data) {
-            if (auto* val = std::get_if<T>(&latest_data)) {
-                var = *val;
-            }
-        });
     }
 
+    /**
+     * @brief Subscribes to the display and control fields so metadata() has units and limits.
+     *
+     * By default the monitor only carries display when a string variable needs its precision.
+     */
+    void monitor_metadata();
+
+    /**
+     * @brief Subscribes to the timeStamp field and records when each update passes each stage.
+     *
+     * The update's timeStamp and the time the monitor callback took it are attached
+     * to its values, and PVGroup::sync() and PVGroup::frame_drawn() add the rest.
+     * The initial value of each subscription keeps a zero source time, since its
+     * timeStamp is that of the PV's last change. Safe to call from any thread
+     * before the PV's monitor is started, afterwards only from the thread that
+     * calls sync(). Tracing can't be turned off again.
+     */
+    void trace_latency();
+
+    /**
+     * @brief Gets the histogram of the PV's latency from timeStamp to the terminal.
+     *
+     * Safe to call from any thread.
+     * @return The histogram, or null unless trace_latency() was called.
+     */
+    std::shared_ptr<const PVLatency> latency() const { return std::atomic_load(&latency_); }
+
+    /**
+     * @brief Gets the PV's cached display metadata.
+     *
+     * The cache is filled from the first monitor update and replaced only when an
+     * update changes the display, control or enum choice fields. Safe to call from any thread.
+     * @return A shared_ptr to the newest metadata, never null.
+     */
+    std::shared_ptr<const PVMetadata> metadata() const { return std::atomic_load(&metadata_); }
+
     /**
      * @brief Gets the underlying PVA monitor instance.
      * @return A reference to the pvac::Monitor object.
@@ -124,17 +688,62 @@ struct PVHandler : public pvac::ClientChannel::MonitorCallback {
     std::shared_ptr<ConnectionMonitor> get_connection_monitor() const { return connection_monitor_; }
 
   private:
-    /// @brief A monitor slot holding one typed MonitorVar and its sync callbacks.
-    struct MonitorSlot {
-        MonitorVar data;                                           ///< The latest value for this type.
-        std::vector<std::function<void(const MonitorVar&)>> tasks; ///< Callbacks to copy data to user variables.
-    };
-
-    std::mutex mutex_;
+    // Lets tests queue updates on the monitor by clearing monitor_started_
+    friend struct MonitorTestAccess;
+    std::mutex monitor_mutex_;                              ///< Serializes polling of monitor_.
     pvac::Monitor monitor_;                                 ///< PVA data monitor.
+    bool monitor_started_ = false;                          ///< True once monitor_ is subscribed.
+    bool initial_update_ = true;                            ///< The next update is a subscription's first.
+
+    bool metadata_requested_ = false;                           ///< Set by monitor_metadata().
+    std::shared_ptr<const PVMetadata> metadata_;                ///< Published metadata, never null.
+    const epics::pvData::PVStructure* metadata_root_ = nullptr; ///< Structure metadata_ was read from.
+    std::vector<std::pair<size_t, size_t>> metadata_fields_;    ///< Offset ranges of the metadata fields.
+    std::vector<size_t> metadata_parents_;                      ///< Offsets of structures containing them.
+    std::pair<size_t, size_t> value_field_;                     ///< Offset range of the value field.
     std::shared_ptr<ConnectionMonitor> connection_monitor_; ///< Monitors connection status.
-    std::unordered_map<std::type_index, MonitorSlot> monitor_slots_; ///< One slot per monitored type.
+    MonitorSlots slots_;                                    ///< One slot per monitored type.
     std::atomic<bool> new_data_ = false;
+    uint64_t generation_ = 0; ///< Updating sync() calls, read by renderers on the same thread.
+    std::atomic<size_t> conversion_errors_ = 0; ///< Updates with a slot that failed to convert.
+    std::atomic<size_t> dropped_updates_ = 0;   ///< Queued updates merged into a newer one.
+    std::atomic<uint64_t> monitor_events_ = 0;  ///< Updates taken from the monitor queue.
+    epics::pvData::BitSet drained_changed_;     ///< Changes of the updates merged by poll_monitor().
+
+    std::atomic<bool> tracing_ = false;                           ///< Set by trace_latency().
+    std::shared_ptr<PVLatency> latency_;                          ///< Null unless tracing.
+    const epics::pvData::PVLong* timestamp_seconds_ = nullptr;    ///< timeStamp.secondsPastEpoch, if any.
+    const epics::pvData::PVInt* timestamp_nanoseconds_ = nullptr; ///< timeStamp.nanoseconds, if any.
+    UpdateTrace::time_point last_traced_{};                       ///< Last update counted by sync().
+
+    friend class DirtyList;
+    friend struct PVGroup;
+    bool closed_ = false;              ///< Set by close(), after which no monitor is started.
+    std::atomic<bool> pinned_ = false; ///< Added with PVGroup::add(), so kept without subscriptions.
+    std::atomic<int> users_ = 0;       ///< Subscriptions to the PV held through PVGroup.
+    int active_users_ = 0;             ///< Active subscriptions, the PV is paused without any.
+
+    pvac::ClientProvider& provider_;   ///< Provider channel is connected through.
+    std::atomic<bool> paused_ = false; ///< While set, no monitor is started.
+    bool channel_open_ = false;        ///< Set once channel has been connected.
+
+    std::shared_ptr<DirtyList> dirty_list_;  ///< List to push to on new data, may be null.
+    std::atomic<bool> dirty_queued_ = false; ///< True while this handler is in dirty_list_.
+    PVHandler* dirty_next_ = nullptr;        ///< Next handler in dirty_list_.
+
+    friend class PutQueue;
+    std::mutex put_mutex_;                         ///< Protects put_result_.
+    PutStatus put_result_;                         ///< Result of the last completed put.
+    std::atomic<int> puts_in_flight_ = 0;          ///< Puts issued and not yet completed.
+    std::atomic<bool> put_status_changed_ = false; ///< A put completed since the last sync().
+    PutStatus put_status_;                         ///< Status published by sync().
+    std::shared_ptr<PutQueue> put_queue_;          ///< Declared last so a private queue stops first.
+
+    /**
+     * @brief Records the result of a put. Called by PutQueue from a pvAccess thread.
+     * @param status The outcome of the put.
+     */
+    void put_done(const PutStatus& status);
 
     /**
      * @brief Callback invoked when a monitor event occurs (e.g., new data).
@@ -142,12 +751,141 @@ struct PVHandler : public pvac::ClientChannel::MonitorCallback {
      */
     void monitorEvent(const pvac::MonitorEvent& evt) override final;
 
+    /**
+     * @brief Drains the monitor queue into the slots.
+     *
+     * Only the newest value reaches the subscribers, so when several updates are
+     * queued the older ones are merged into the monitor's structure and counted in
+     * dropped_updates() instead of being converted.
+     */
+    void poll_monitor();
+
+    /**
+     * @brief Cancels the current monitor, if any, and subscribes with a request built from the slots.
+     */
+    void restart_monitor();
+
+    /**
+     * @brief Cancels the current monitor, if any, waiting for running callbacks to return.
+     */
+    void stop_monitor();
+
+    /**
+     * @brief Unregisters a variable, restarting the monitor if the remaining slots need fewer fields.
+     * @param slot The variable's slot index.
+     * @param var The address of the variable.
+     */
+    void unset_monitor(size_t slot, const void* var);
+
+    /**
+     * @brief Stops the monitor and connection callbacks of a PV removed from its PVGroup.
+     */
+    void close();
+
+    /**
+     * @brief Connects the channel, unless already connected.
+     */
+    void open_channel();
+
+    /**
+     * @brief Cancels the monitor until resume() is called. The channel stays connected.
+     */
+    void pause();
+
+    /**
+     * @brief Connects the channel if needed and restarts the monitor cancelled by pause().
+     */
+    void resume();
+
     /**
      * @brief Extracts the PV value from the event and copies it to
      * monitored variable via the sync callback
+     *
+     * Skipped unless the update changes the value field or the metadata.
+     * @param pstruct The PVStructure containing the new data.
+     * @param changed The fields of pstruct changed by this update.
+     */
+    void update_monitored_variable(const epics::pvData::PVStructure::const_shared_pointer& pstruct,
+                                   const epics::pvData::BitSet& changed);
+
+    /**
+     * @brief Re-reads metadata_ if the update touches a metadata field.
+     *
+     * Also finds the offsets of the value field when pstruct is a new structure.
      * @param pstruct A pointer to the PVStructure containing the new data.
+     * @param changed The fields of pstruct changed by this update.
+     * @return True if metadata_ was replaced.
+     */
+    bool update_metadata(const epics::pvData::PVStructure* pstruct, const epics::pvData::BitSet& changed);
+
+    /**
+     * @brief Stamps an update with its timeStamp and the current time.
+     *
+     * Called from the monitor callback while tracing, after update_metadata() has
+     * found the timeStamp fields of the update's structure.
+     * @param initial Whether this is the first update of a subscription, whose source is left zero.
+     * @return The update's trace so far.
+     */
+    UpdateTrace trace_update(bool initial) const;
+};
+
+/**
+ * @brief A reference-counted claim on a PV in a PVGroup, and optionally on a monitored variable.
+ *
+ * Returned by PVGroup::acquire() and PVGroup::subscribe(), and shared between copies.
+ * When the last copy is destroyed or reset, the variable stops being updated, and
+ * once no subscriptions to the PV remain it is removed from the group, which
+ * cancels its monitor and closes its channel. Must be released on the thread
+ * that calls PVGroup::sync(), before the PVGroup is destroyed.
+ */
+class Subscription {
+  public:
+    /**
+     * @brief Constructs an empty Subscription.
+     */
+    Subscription() = default;
+
+    /**
+     * @brief Releases this copy's share of the subscription.
      */
-    void update_monitored_variable(const epics::pvData::PVStructure* pstruct);
+    void reset() { token_.reset(); }
+
+    /**
+     * @brief Checks if the Subscription holds a claim.
+     * @return True unless default constructed or reset.
+     */
+    explicit operator bool() const { return token_ != nullptr; }
+
+    /**
+     * @brief Activates or deactivates the subscription, shared between its copies.
+     *
+     * The PVGroup counts the active subscriptions to each PV. A PV whose
+     * subscriptions are all inactive has its monitor cancelled, and is not
+     * connected at all until one is first activated. Must be called from the
+     * thread that calls PVGroup::sync().
+     * @param active Whether the subscription should be active.
+     */
+    void set_active(bool active);
+
+    /**
+     * @brief Checks if the subscription is active.
+     * @return True if active, false if inactive or empty.
+     */
+    bool active() const;
+
+    /**
+     * @brief Gets the slot of the subscribed variable, for PVHandler::conversion_failed().
+     * @return The slot index, or 0 for an empty Subscription or one without a variable.
+     */
+    size_t slot() const;
+
+  private:
+    friend struct PVGroup;
+    struct Token;
+
+    explicit Subscription(std::shared_ptr<Token> token) : token_(std::move(token)) {}
+
+    std::shared_ptr<Token> token_; ///< Releases the claim when the last copy is destroyed.
 };
 
 /**
@@ -155,6 +893,12 @@ struct PVHandler : public pvac::ClientChannel::MonitorCallback {
  *
  * This class provides a centralized way to add, access, and monitor a group of
  * PVs, handling the underlying connections and data updates.
+ *
+ * The PVs are split across shards by name. Each shard publishes an immutable
+ * snapshot of its PVs, and adds to different shards don't contend with each other.
+ * Lookups are short-lock, not lock-free: the snapshot is loaded with
+ * std::atomic_load, which libstdc++ implements with a global pool of mutexes held
+ * only for the pointer copy, so a lookup never waits for add() to connect a PV.
  */
 struct PVGroup {
   public:
@@ -171,12 +915,119 @@ struct PVGroup {
      */
     PVGroup(pvac::ClientProvider& provider);
 
+    /**
+     * @brief Destroys the PVGroup, cancelling any puts still in flight.
+     */
+    ~PVGroup();
+
     /**
      * @brief Adds a new PV to the group. If the PV already exists, this is a no-op.
+     *
+     * PVs added this way stay in the group until remove() is called, even after
+     * their Subscriptions are released. Safe to call from any thread, concurrently
+     * with lookups and other adds.
      * @param pv_name The name of the PV to add.
      */
     void add(const std::string& pv_name);
 
+    /**
+     * @brief Adds several PVs to the group, copying each affected shard only once.
+     * @param pv_names The names of the PVs to add. Names already in the group are skipped.
+     */
+    void add(const std::vector<std::string>& pv_names);
+
+    /**
+     * @brief Adds the PVs which Subscriptions are about to be taken for, copying each shard only once.
+     *
+     * Each acquire() or subscribe() of a new PV copies its shard, so taking many
+     * Subscriptions one by one costs time quadratic in the number of PVs. Calling
+     * this first with all of their names avoids that. The PVs are not pinned and
+     * stay disconnected until subscribed. A PV which never gets a Subscription stays
+     * in the group until remove() is called. Safe to call from any thread.
+     * @param pv_names The names of the PVs. Names already in the group are skipped.
+     */
+    void prepare(const std::vector<std::string>& pv_names);
+
+    /**
+     * @brief Adds a PV to the group if needed and takes a reference to it.
+     *
+     * A PV added only through acquire() and subscribe() is removed from the group
+     * when its last Subscription is released. Must be called from the thread that calls sync().
+     * @param pv_name The name of the PV.
+     * @return A Subscription which keeps the PV in the group until released.
+     */
+    Subscription acquire(const std::string& pv_name);
+
+    /**
+     * @brief Adds a PV to the group if needed and registers a variable to be updated by it.
+     *
+     * Unlike set_monitor(), the variable is unregistered when the returned
+     * Subscription is released. Must be called from the thread that calls sync().
+     * @tparam T The type of the variable to monitor.
+     * @param pv_name The name of the PV to monitor.
+     * @param var A reference to the variable that will be updated.
+     * @return A Subscription which keeps the PV in the group and var registered until released.
+     */
+    template <typename T>
+    Subscription subscribe(const std::string& pv_name, T& var) {
+        this->insert({pv_name}, false);
+        this->get_pv(pv_name).set_monitor(var);
+        return this->make_subscription(pv_name, MonitorSlots::slot_index<T>(), &var);
+    }
+
+    /**
+     * @brief Like subscribe(), but the Subscription starts inactive and is never captured.
+     *
+     * The PV is not connected until the caller activates the Subscription. Used by
+     * widgets which decide themselves which of their PVs to monitor, such as PVTable.
+     * Must be called from the thread that calls sync().
+     * @tparam T The type of the variable to monitor.
+     * @param pv_name The name of the PV to monitor.
+     * @param var A reference to the variable that will be updated while active.
+     * @return An inactive Subscription which keeps the PV in the group and var registered until released.
+     */
+    template <typename T>
+    Subscription subscribe_inactive(const std::string& pv_name, T& var) {
+        this->insert({pv_name}, false);
+        this->get_pv(pv_name).set_monitor(var);
+        return this->make_subscription(pv_name, MonitorSlots::slot_index<T>(), &var, false);
+    }
+
+    /**
+     * @brief Removes a PV from the group, cancelling its monitor and closing its channel.
+     *
+     * Subscriptions to the PV keep its PVHandler alive, but it receives no more
+     * data. The handler is freed by a later sync() once it has no puts in flight.
+     * Must be called from the thread that calls sync().
+     * @param pv_name The name of the PV to remove.
+     * @return True if the PV was in the group, false otherwise.
+     */
+    bool remove(const std::string& pv_name);
+
+    /**
+     * @brief Collects the Subscriptions taken from now on into a list, starting them inactive.
+     *
+     * Used by DisplayBase so that none of a display's PVs are connected until it is
+     * shown. The capture lasts until stop_capture(), end_capture() or the next
+     * begin_capture(). The next sync() activates the Subscriptions of every list that
+     * has not been passed to end_capture(). Must be called from the thread that calls sync().
+     * @param subscriptions The list to collect into. Must stay valid until passed to end_capture().
+     */
+    void begin_capture(std::vector<Subscription>& subscriptions);
+
+    /**
+     * @brief Stops collecting into a list passed to begin_capture(), leaving it to be activated by sync().
+     * @param subscriptions The list passed to begin_capture(). Other lists are ignored.
+     */
+    void stop_capture(std::vector<Subscription>& subscriptions);
+
+    /**
+     * @brief Stops collecting into a list passed to begin_capture(), and settles its state.
+     * @param subscriptions The list passed to begin_capture(). Other lists are ignored.
+     * @param activate Whether to activate the collected Subscriptions now.
+     */
+    void end_capture(std::vector<Subscription>& subscriptions, bool activate);
+
     /**
      * @brief Registers a variable to be updated by a specific PV in the group.
      * @tparam T The type of the variable to monitor.
@@ -187,11 +1038,13 @@ struct PVGroup {
     template <typename T>
     void set_monitor(const std::string& pv_name, T& var) {
         PVHandler& pv = this->get_pv(pv_name);
+        // the variable is registered for good, so the PV has to keep running
+        this->pin(pv);
         pv.set_monitor(var);
     }
 
     /**
-     * @brief Retrieves a PVHandler from the group by its name.
+     * @brief Retrieves a PVHandler from the group by its name. Short-lock, see find().
      * @param pv_name The name of the PV to retrieve.
      * @return A reference to the corresponding PVHandler object.
      * @throws std::runtime_error if the PV is not found.
@@ -215,14 +1068,195 @@ struct PVGroup {
     PVHandler& operator[](const std::string& pv_name);
 
     /**
-     * @brief Checks if any PV in the group has received new data.
+     * @brief Syncs the PVs in the group which have received new data.
+     *
+     * Only PVs which received data since the last call are visited, so the cost
+     * scales with the number of changed PVs rather than the size of the group.
      * @return True if new data is available in any monitor, false otherwise.
      */
     bool sync();
 
+    /**
+     * @brief Blocks until a PV in the group receives new data or wake() is called.
+     *
+     * Intended for a single thread which calls sync() (or arranges for it to be
+     * called) after each return. Data which arrives before sync() has run does
+     * not wake the waiter again.
+     */
+    void wait_for_data();
+
+    /**
+     * @brief Blocks until a PV in the group receives new data, wake() is called,
+     * or the timeout expires.
+     * @param timeout Maximum time to wait.
+     * @return True if woken, false on timeout.
+     */
+    bool wait_for_data(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Wakes a thread blocked in wait_for_data().
+     */
+    void wake();
+
+    /**
+     * @brief Gets the queue which issues puts for the PVs in the group.
+     * @return A reference to the PutQueue.
+     */
+    const PutQueue& put_queue() const { return *put_queue_; }
+
+    /**
+     * @brief Gets the number of monitor updates that failed to convert, summed over the group.
+     * @return The total of PVHandler::conversion_errors() for every PV.
+     */
+    size_t conversion_errors() const;
+
+    /**
+     * @brief Gets the number of monitor updates dropped for a newer one, summed over the group.
+     * @return The total of PVHandler::dropped_updates() for every PV.
+     */
+    size_t dropped_updates() const;
+
+    /**
+     * @brief Gets the durations of the sync() calls so far. Safe to call from any thread.
+     * @return The histogram sync() records its own duration into.
+     */
+    const LatencyHistogram& sync_time() const { return sync_time_; }
+
+    /**
+     * @brief Gets the number of PVs the last sync() found in the dirty list.
+     *
+     * Safe to call from any thread. This is the depth of the queue of PVs with new
+     * data at the time the UI thread drained it.
+     * @return The number of PVs visited by the last sync().
+     */
+    size_t last_sync_pvs() const { return last_sync_pvs_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets the connection state and monitor counters of every PV in the group.
+     *
+     * The events_per_sec and source_to_paint of each entry are left at zero, as
+     * rates depend on the caller's sampling interval and the latency statistics
+     * take a pass over the PV's histogram. Safe to call from any thread.
+     * @return One entry per PV, in no particular order.
+     */
+    std::vector<PVMetrics> pv_metrics() const;
+
+    /**
+     * @brief Records the latency of every update in the group, from its timeStamp to the terminal.
+     *
+     * Calls PVHandler::trace_latency() for the PVs in the group and every PV added
+     * later. Each update is timed from its timeStamp to the monitor callback, to
+     * sync(), and to the next frame_drawn(), into latency() and the PV's own
+     * histogram. Adds about 16 bytes to each update on the wire and 4 kB of
+     * counters per PV. Must be called from the thread that calls sync().
+     */
+    void trace_latency();
+
+    /**
+     * @brief Like trace_latency(), and also writes every traced update to a file.
+     *
+     * The file is in the Chrome trace event format, see TraceWriter, and is
+     * closed when the PVGroup is destroyed. Must be called from the thread that calls sync().
+     * @param path The file to write.
+     * @throws std::runtime_error if the file can't be opened.
+     */
+    void trace_to_file(const std::string& path);
+
+    /**
+     * @brief Marks the values taken by the sync() calls since the last call as drawn to the terminal.
+     *
+     * App::run calls this after each frame it draws. Loops which draw frames
+     * themselves should call it after a frame is flushed for the latency
+     * tracing to cover the last stage. Must be called from the thread that calls sync().
+     */
+    void frame_drawn();
+
+    /**
+     * @brief Gets the latency of the traced updates of all PVs. Safe to call from any thread.
+     * @return The histograms of each stage, empty unless tracing.
+     */
+    const LatencyStages& latency() const { return latency_; }
+
   private:
-    std::mutex mutex_;
-    pvac::ClientProvider& provider_;                                    ///< PVA client provider.
-    std::unordered_map<std::string, std::shared_ptr<PVHandler>> pv_map; ///< Map of PVs by name.
+    /// @brief Number of independently updated parts of the PV map.
+    static constexpr size_t NUM_SHARDS = 16;
+
+    using PVMap = std::unordered_map<std::string, std::shared_ptr<PVHandler>>;
+
+    /**
+     * @brief The PVs whose names hash to one shard.
+     *
+     * Readers atomically load the snapshot, holding a pooled mutex only while the
+     * pointer is copied. Writers serialize on write_mutex, copy the snapshot, modify
+     * the copy and publish it in place of the old one, which is freed once the last
+     * reader holding it is done.
+     */
+    struct Shard {
+        std::mutex write_mutex;                                        ///< Serializes writers.
+        std::shared_ptr<const PVMap> pvs = std::make_shared<PVMap>(); ///< Current snapshot, never null.
+    };
+
+    /// @brief Gets the index of the shard a PV name belongs to.
+    static size_t shard_index(const std::string& pv_name);
+
+    /// @brief Adds the PVs which are not in the group yet, marking all of them as pinned if pin is set.
+    void insert(const std::vector<std::string>& pv_names, bool pin);
+
+    /// @brief Looks up a PV in its shard's snapshot, returning null if it is not in the group. Holds
+    /// only the atomic_load mutex, never the shard's write_mutex.
+    std::shared_ptr<PVHandler> find(const std::string& pv_name) const;
+
+    friend struct Subscription::Token;
+
+    /// @brief Counts a user of a PV already in the group and returns its Subscription, which is captured
+    /// or activated unless automatic is false.
+    Subscription make_subscription(const std::string& pv_name, size_t slot, void* var, bool automatic = true);
+
+    /// @brief Drops a user of a PV, unregistering its variable if set, and retires the PV after the last one.
+    void release(Subscription::Token& token);
+
+    /// @brief Removes a PV from its shard if still there, closes it and queues it to be freed.
+    void retire(const std::shared_ptr<PVHandler>& pv);
+
+    /// @brief Frees retired PVs which have no puts in flight and are not in the dirty list.
+    void free_retired();
+
+    /// @brief Marks a PV as pinned, resuming it if it was paused.
+    void pin(PVHandler& pv);
+
+    /// @brief Counts a Subscription as active or inactive, pausing or resuming its PV.
+    void set_active(Subscription::Token& token, bool active);
+
+    std::shared_ptr<DirtyList> dirty_list_;  ///< PVs with unsynced data.
+    std::shared_ptr<PutQueue> put_queue_;    ///< Issues puts for all PVs.
+    pvac::ClientProvider& provider_;         ///< PVA client provider.
+    std::array<Shard, NUM_SHARDS> shards_;   ///< PVs by name, split by hash.
+
+    std::mutex retired_mutex_;                        ///< Protects retired_.
+    std::vector<std::shared_ptr<PVHandler>> retired_; ///< Removed PVs waiting to be freed by sync().
+    std::atomic<bool> has_retired_ = false;           ///< Set while retired_ is not empty.
+
+    std::vector<Subscription>* capture_ = nullptr;    ///< List collecting new Subscriptions.
+    std::vector<std::vector<Subscription>*> pending_; ///< Captured lists to activate on sync().
+
+    LatencyHistogram sync_time_;            ///< Duration of each sync().
+    std::atomic<size_t> last_sync_pvs_ = 0; ///< Handlers taken from the dirty list by the last sync().
+
+    /// @brief A synced update waiting for frame_drawn().
+    struct PendingTrace {
+        std::shared_ptr<PVLatency> pv; ///< Latency of the update's PV, which may be removed meanwhile.
+        UpdateTrace trace;             ///< Stages up to sync().
+    };
+
+    /// @brief Bound on pending_traces_ for loops which never call frame_drawn().
+    static constexpr size_t MAX_PENDING_TRACES = 1 << 16;
+
+    /// @brief Counts the stages of a PV's update taken by sync(), unless already counted.
+    void trace_synced(PVHandler& pv, UpdateTrace::time_point now);
+
+    std::atomic<bool> tracing_ = false;         ///< Set by trace_latency().
+    LatencyStages latency_;                     ///< Latency of the traced updates of all PVs.
+    std::vector<PendingTrace> pending_traces_;  ///< Updates synced since the last frame_drawn().
+    std::unique_ptr<TraceWriter> trace_writer_; ///< Writes the traces, if trace_to_file() was called.
 };
 } // namespace pvtui
@@ -1,5 +1,6 @@
 #pragma once
 
 #include <pvtui/app.hpp>
+#include <pvtui/metrics.hpp>
 #include <pvtui/pvgroup.hpp>
 #include <pvtui/widgets.hpp>
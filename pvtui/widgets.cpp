@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <stdexcept>
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/component_options.hpp>
+#include <ftxui/component/event.hpp>
+#include <ftxui/component/mouse.hpp>
 
 #include <pvtui/widgets.hpp>
 
@@ -23,15 +26,28 @@ std::string rectangle(int len) {
 
 namespace {
 
-ftxui::Component make_button_widget(PVHandler& pv, const std::string& label, int value) {
+// Draws a control in the INVALID color while the last put to its connected PV has failed.
+// The innermost color wins in FTXUI, so this shows through styles like EPICSColor::edit().
+ftxui::Component show_put_state(PVHandler& pv, ftxui::Component control) {
+    ftxui::ComponentBase* inner = control.get();
+    return ftxui::Renderer(control, [&pv, inner] {
+        ftxui::Element element = inner->Render();
+        if (pv.connected() && pv.put_status().state == PutStatus::State::Failed) {
+            element |= EPICSColor::INVALID;
+        }
+        return element;
+    });
+}
+
+ftxui::Component make_button_widget(PVHandler& pv, const std::string& label, int value, PutPolicy policy) {
     auto op = ftxui::ButtonOption::Ascii();
     op.label = label;
-    op.on_click = [&pv, value]() {
+    op.on_click = [&pv, value, policy]() {
         if (pv.connected()) {
-            pv.channel.put().set("value", value).exec();
+            pv.put("value", value, policy);
         }
     };
-    return ftxui::Button(op);
+    return show_put_state(pv, ftxui::Button(op));
 }
 
 template <typename T>
@@ -45,7 +61,7 @@ bool put_string_as(std::string_view str, PVHandler& pv) {
         } else if constexpr (std::is_same_v<T, std::string>) {
             val = str;
         }
-        pv.channel.put().set("value", val).exec();
+        pv.put("value", std::move(val));
     } catch (...) {
         return false;
     }
@@ -87,28 +103,45 @@ ftxui::Component make_input_widget(PVHandler& pv, std::string& disp_str, PVPutTy
         }
     };
 
-    return ftxui::Input(input_op);
+    return show_put_state(pv, ftxui::Input(input_op));
 }
 
-ftxui::Component make_choice_h_widget(PVHandler& pv, const std::vector<std::string>& labels, int& selected) {
+// Presents the labels in a PVEnum's current ChoiceTable to FTXUI menus. The
+// table is looked up on each access, so a new table from the server is picked
+// up without rebuilding the component.
+class ChoiceLabels : public ftxui::ConstStringListRef::Adapter {
+  public:
+    explicit ChoiceLabels(std::shared_ptr<PVEnum> value) : value_(std::move(value)) {}
+    size_t size() const override { return value_->choices.size(); }
+    std::string operator[](size_t i) const override { return value_->choices[i]; }
+    int& selected() const { return value_->index; }
+
+  private:
+    std::shared_ptr<PVEnum> value_;
+};
+
+ftxui::Component make_choice_h_widget(PVHandler& pv, const std::shared_ptr<PVEnum>& value, PutPolicy policy) {
+    // the component's callbacks own the adapter so it lives as long as the menu
+    auto labels = std::make_shared<ChoiceLabels>(value);
     ftxui::MenuOption op = ftxui::MenuOption::Toggle();
-    op.entries = &labels;
-    op.selected = &selected;
-    op.on_change = [&]() {
+    op.entries = labels.get();
+    op.selected = &labels->selected();
+    op.on_change = [&pv, labels, policy]() {
         if (pv.connected()) {
-            pv.channel.put().set("value.index", selected).exec();
+            pv.put("value.index", labels->selected(), policy);
         }
     };
-    return ftxui::Menu(op);
+    return show_put_state(pv, ftxui::Menu(op));
 }
 
-ftxui::Component make_choice_v_widget(PVHandler& pv, const std::vector<std::string>& labels, int& selected) {
+ftxui::Component make_choice_v_widget(PVHandler& pv, const std::shared_ptr<PVEnum>& value, PutPolicy policy) {
+    auto labels = std::make_shared<ChoiceLabels>(value);
     ftxui::MenuOption op = ftxui::MenuOption::Vertical();
-    op.entries = &labels;
-    op.selected = &selected;
-    op.on_change = [&]() {
+    op.entries = labels.get();
+    op.selected = &labels->selected();
+    op.on_change = [&pv, labels, policy]() {
         if (pv.connected()) {
-            pv.channel.put().set("value.index", selected).exec();
+            pv.put("value.index", labels->selected(), policy);
         }
     };
     op.entries_option.transform = [&pv](const ftxui::EntryState& state) {
@@ -124,19 +157,20 @@ ftxui::Component make_choice_v_widget(PVHandler& pv, const std::vector<std::stri
         }
         return e;
     };
-    return ftxui::Menu(op);
+    return show_put_state(pv, ftxui::Menu(op));
 }
 
-ftxui::Component make_dropdown_widget(PVHandler& pv, const std::vector<std::string>& labels, int& selected) {
+ftxui::Component make_dropdown_widget(PVHandler& pv, const std::shared_ptr<PVEnum>& value, PutPolicy policy) {
     using namespace ftxui;
 
+    auto labels = std::make_shared<ChoiceLabels>(value);
     DropdownOption dropdown_op;
 
-    dropdown_op.radiobox.entries = &labels;
-    dropdown_op.radiobox.selected = &selected;
-    dropdown_op.radiobox.on_change = [&]() {
+    dropdown_op.radiobox.entries = labels.get();
+    dropdown_op.radiobox.selected = &labels->selected();
+    dropdown_op.radiobox.on_change = [&pv, labels, policy]() {
         if (pv.connected()) {
-            pv.channel.put().set("value.index", selected).exec();
+            pv.put("value.index", labels->selected(), policy);
         }
     };
 
@@ -153,39 +187,63 @@ ftxui::Component make_dropdown_widget(PVHandler& pv, const std::vector<std::stri
             filler(),
         });
     };
-    return ftxui::Dropdown(dropdown_op);
+    return show_put_state(pv, ftxui::Dropdown(dropdown_op));
 }
 
-ftxui::Component make_bits_widget(int& value, size_t nbits) {
+ftxui::Component make_bits_widget(const WidgetBase& widget, const int& value, size_t nbits) {
     using namespace ftxui;
-    return Renderer([&value, nbits] {
-        Elements rows;
-        for (size_t i = 0; i < nbits; i++) {
-            int v = value & (1u << i);
-            auto clr = v ? color(Color::Green) : color(Color::GrayDark);
-            rows.push_back(text(unicode::rectangle(2)) | clr);
-        }
-        return vbox({rows});
+    return Renderer([&widget, &value, nbits] {
+        return widget.cached([&value, nbits] {
+            Elements rows;
+            for (size_t i = 0; i < nbits; i++) {
+                int v = value & (1u << i);
+                auto clr = v ? color(Color::Green) : color(Color::GrayDark);
+                rows.push_back(text(unicode::rectangle(2)) | clr);
+            }
+            return vbox({rows});
+        });
     });
 }
 
+std::vector<std::string> replace_all(const ArgParser& args, const std::vector<std::string>& names) {
+    std::vector<std::string> replaced;
+    replaced.reserve(names.size());
+    for (const std::string& name : names) {
+        replaced.push_back(args.replace(name));
+    }
+    return replaced;
+}
+
 } // namespace
 
-WidgetBase::WidgetBase(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name)
-    : pvgroup_(pvgroup), pv_name_(args.replace(pv_name)) {
-    pvgroup.add(pv_name_);
-    connection_monitor_ = pvgroup[pv_name_].get_connection_monitor();
+WidgetBase::WidgetBase(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name, bool acquire)
+    : WidgetBase(pvgroup, args.replace(pv_name), acquire) {}
+
+WidgetBase::WidgetBase(PVGroup& pvgroup, const std::string& pv_name, bool acquire)
+    : pvgroup_(pvgroup), pv_name_(pv_name) {
+    if (acquire) {
+        subscription_ = pvgroup.acquire(pv_name);
+        this->attach();
+    }
 }
 
-WidgetBase::WidgetBase(PVGroup& pvgroup, const std::string& pv_name) : pvgroup_(pvgroup), pv_name_(pv_name) {
-    pvgroup.add(pv_name_);
-    connection_monitor_ = pvgroup[pv_name_].get_connection_monitor();
+void WidgetBase::attach() {
+    pv_ = pvgroup_.get_pv_shared(pv_name_);
+    connection_monitor_ = pv_->get_connection_monitor();
 }
 
 std::string WidgetBase::pv_name() const { return pv_name_; }
 
 bool WidgetBase::connected() const { return connection_monitor_->connected(); }
 
+const PutStatus& WidgetBase::put_status() const { return pv_->put_status(); }
+
+std::shared_ptr<const PVMetadata> WidgetBase::metadata() const { return pv_->metadata(); }
+
+bool WidgetBase::conversion_failed() const { return pv_->conversion_failed(subscription_.slot()); }
+
+uint64_t WidgetBase::generation() const { return pv_->generation(); }
+
 ftxui::Component WidgetBase::component() const {
     if (component_) {
         return component_;
@@ -196,95 +254,93 @@ ftxui::Component WidgetBase::component() const {
 
 InputWidget::InputWidget(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name,
                          PVPutType put_type, ftxui::Color fg, ftxui::Color hover)
-    : WidgetBase(pvgroup, args, pv_name), value_ptr_(std::make_shared<std::string>()) {
-    pvgroup.set_monitor(pv_name_, *value_ptr_);
-    component_ = make_input_widget(pvgroup.get_pv(pv_name_), *value_ptr_, put_type, fg, hover);
+    : WidgetBase(pvgroup, args, pv_name, false), value_ptr_(std::make_shared<std::string>()) {
+    this->subscribe(*value_ptr_);
+    component_ = make_input_widget(*pv_, *value_ptr_, put_type, fg, hover);
 }
 
 InputWidget::InputWidget(App& app, const std::string& pv_name, PVPutType put_type, ftxui::Color fg,
                          ftxui::Color hover)
-    : WidgetBase(app.pvgroup, app.args, pv_name), value_ptr_(std::make_shared<std::string>()) {
-    app.pvgroup.set_monitor(pv_name_, *value_ptr_);
-    component_ = make_input_widget(app.pvgroup.get_pv(pv_name_), *value_ptr_, put_type, fg, hover);
+    : WidgetBase(app.pvgroup, app.args, pv_name, false), value_ptr_(std::make_shared<std::string>()) {
+    this->subscribe(*value_ptr_);
+    component_ = make_input_widget(*pv_, *value_ptr_, put_type, fg, hover);
 }
 
 InputWidget::InputWidget(PVGroup& pvgroup, const std::string& pv_name, PVPutType put_type, ftxui::Color fg,
                          ftxui::Color hover)
-    : WidgetBase(pvgroup, pv_name), value_ptr_(std::make_shared<std::string>()) {
-    pvgroup.set_monitor(pv_name_, *value_ptr_);
-    component_ = make_input_widget(pvgroup.get_pv(pv_name_), *value_ptr_, put_type, fg, hover);
+    : WidgetBase(pvgroup, pv_name, false), value_ptr_(std::make_shared<std::string>()) {
+    this->subscribe(*value_ptr_);
+    component_ = make_input_widget(*pv_, *value_ptr_, put_type, fg, hover);
 }
 
 const std::string& InputWidget::value() const { return *value_ptr_; }
 
 BitsWidget::BitsWidget(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name, size_t nbits)
-    : WidgetBase(pvgroup, args, pv_name), value_ptr_(std::make_shared<int>()) {
-    pvgroup.set_monitor(pv_name_, *value_ptr_);
-    component_ = make_bits_widget(*value_ptr_, nbits);
+    : WidgetBase(pvgroup, args, pv_name, false), value_ptr_(std::make_shared<int>()) {
+    this->subscribe(*value_ptr_);
+    component_ = make_bits_widget(*this, *value_ptr_, nbits);
 }
 
 BitsWidget::BitsWidget(PVGroup& pvgroup, const std::string& pv_name, size_t nbits)
-    : WidgetBase(pvgroup, pv_name), value_ptr_(std::make_shared<int>()) {
-    pvgroup.set_monitor(pv_name_, *value_ptr_);
-    component_ = make_bits_widget(*value_ptr_, nbits);
+    : WidgetBase(pvgroup, pv_name, false), value_ptr_(std::make_shared<int>()) {
+    this->subscribe(*value_ptr_);
+    component_ = make_bits_widget(*this, *value_ptr_, nbits);
 }
 
 BitsWidget::BitsWidget(App& app, const std::string& pv_name, size_t nbits)
-    : WidgetBase(app.pvgroup, app.args, pv_name), value_ptr_(std::make_shared<int>()) {
-    app.pvgroup.set_monitor(pv_name_, *value_ptr_);
-    component_ = make_bits_widget(*value_ptr_, nbits);
+    : WidgetBase(app.pvgroup, app.args, pv_name, false), value_ptr_(std::make_shared<int>()) {
+    this->subscribe(*value_ptr_);
+    component_ = make_bits_widget(*this, *value_ptr_, nbits);
 }
 
 const int& BitsWidget::value() const { return *value_ptr_; }
 
 ChoiceWidget::ChoiceWidget(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name,
-                           ChoiceStyle style)
-    : WidgetBase(pvgroup, args, pv_name), value_ptr_(std::make_shared<PVEnum>()) {
-    pvgroup.set_monitor(pv_name_, *value_ptr_);
+                           ChoiceStyle style, PutPolicy policy)
+    : WidgetBase(pvgroup, args, pv_name, false), value_ptr_(std::make_shared<PVEnum>()) {
+    this->subscribe(*value_ptr_);
     switch (style) {
     case pvtui::ChoiceStyle::Vertical:
-        component_ = make_choice_v_widget(pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_choice_v_widget(*pv_, value_ptr_, policy);
         break;
     case pvtui::ChoiceStyle::Horizontal:
-        component_ = make_choice_h_widget(pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_choice_h_widget(*pv_, value_ptr_, policy);
         break;
     case pvtui::ChoiceStyle::Dropdown:
-        component_ = make_dropdown_widget(pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_dropdown_widget(*pv_, value_ptr_, policy);
         break;
     }
 }
 
-ChoiceWidget::ChoiceWidget(App& app, const std::string& pv_name, ChoiceStyle style)
-    : WidgetBase(app.pvgroup, app.args, pv_name), value_ptr_(std::make_shared<PVEnum>()) {
-    app.pvgroup.set_monitor(pv_name_, *value_ptr_);
+ChoiceWidget::ChoiceWidget(App& app, const std::string& pv_name, ChoiceStyle style, PutPolicy policy)
+    : WidgetBase(app.pvgroup, app.args, pv_name, false), value_ptr_(std::make_shared<PVEnum>()) {
+    this->subscribe(*value_ptr_);
     switch (style) {
     case pvtui::ChoiceStyle::Vertical:
-        component_ =
-            make_choice_v_widget(app.pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_choice_v_widget(*pv_, value_ptr_, policy);
         break;
     case pvtui::ChoiceStyle::Horizontal:
-        component_ =
-            make_choice_h_widget(app.pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_choice_h_widget(*pv_, value_ptr_, policy);
         break;
     case pvtui::ChoiceStyle::Dropdown:
-        component_ =
-            make_dropdown_widget(app.pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_dropdown_widget(*pv_, value_ptr_, policy);
         break;
     }
 }
 
-ChoiceWidget::ChoiceWidget(PVGroup& pvgroup, const std::string& pv_name, ChoiceStyle style)
-    : WidgetBase(pvgroup, pv_name), value_ptr_(std::make_shared<PVEnum>()) {
-    pvgroup.set_monitor(pv_name_, *value_ptr_);
+ChoiceWidget::ChoiceWidget(PVGroup& pvgroup, const std::string& pv_name, ChoiceStyle style,
+                           PutPolicy policy)
+    : WidgetBase(pvgroup, pv_name, false), value_ptr_(std::make_shared<PVEnum>()) {
+    this->subscribe(*value_ptr_);
     switch (style) {
     case pvtui::ChoiceStyle::Vertical:
-        component_ = make_choice_v_widget(pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_choice_v_widget(*pv_, value_ptr_, policy);
         break;
     case pvtui::ChoiceStyle::Horizontal:
-        component_ = make_choice_h_widget(pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_choice_h_widget(*pv_, value_ptr_, policy);
         break;
     case pvtui::ChoiceStyle::Dropdown:
-        component_ = make_dropdown_widget(pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_dropdown_widget(*pv_, value_ptr_, policy);
         break;
     }
 }
@@ -292,20 +348,142 @@ ChoiceWidget::ChoiceWidget(PVGroup& pvgroup, const std::string& pv_name, ChoiceS
 const PVEnum& ChoiceWidget::value() const { return *value_ptr_; }
 
 ButtonWidget::ButtonWidget(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name,
-                           const std::string& label, int press_val)
+                           const std::string& label, int press_val, PutPolicy policy)
     : WidgetBase(pvgroup, args, pv_name) {
-    component_ = make_button_widget(pvgroup.get_pv(pv_name_), label, press_val);
+    component_ = make_button_widget(*pv_, label, press_val, policy);
 }
 
-ButtonWidget::ButtonWidget(App& app, const std::string& pv_name, const std::string& label, int press_val)
+ButtonWidget::ButtonWidget(App& app, const std::string& pv_name, const std::string& label, int press_val,
+                           PutPolicy policy)
     : WidgetBase(app.pvgroup, app.args, pv_name) {
-    component_ = make_button_widget(app.pvgroup.get_pv(pv_name_), label, press_val);
+    component_ = make_button_widget(*pv_, label, press_val, policy);
 }
 
 ButtonWidget::ButtonWidget(PVGroup& pvgroup, const std::string& pv_name, const std::string& label,
-                           int press_val)
+                           int press_val, PutPolicy policy)
     : WidgetBase(pvgroup, pv_name) {
-    component_ = make_button_widget(pvgroup.get_pv(pv_name_), label, press_val);
+    component_ = make_button_widget(*pv_, label, press_val, policy);
+}
+
+PVTable::PVTable(App& app, const std::vector<std::string>& pv_names, size_t height)
+    : PVTable(app.pvgroup, replace_all(app.args, pv_names), height) {}
+
+PVTable::PVTable(PVGroup& pvgroup, const std::vector<std::string>& pv_names, size_t height)
+    : rows_(pv_names.size()), height_(std::max<size_t>(height, 1)) {
+    // adding the PVs one by one would copy the group's PV map for each row
+    pvgroup.prepare(pv_names);
+    // rows_ is never resized, so the values registered here keep their addresses
+    for (size_t i = 0; i < rows_.size(); i++) {
+        Row& row = rows_[i];
+        row.name = pv_names[i];
+        row.subscription = pvgroup.subscribe_inactive(row.name, row.value);
+        row.pv = pvgroup.get_pv_shared(row.name);
+        name_width_ = std::max(name_width_, static_cast<int>(row.name.size()));
+    }
+    this->update_window();
+
+    component_ = ftxui::Renderer([this](bool focused) { return this->render(focused); }) |
+                 ftxui::CatchEvent([this](ftxui::Event event) { return this->on_event(event); });
+}
+
+void PVTable::select(size_t row) {
+    if (rows_.empty()) {
+        return;
+    }
+    selected_ = std::min(row, rows_.size() - 1);
+    if (selected_ < first_) {
+        this->scroll_to(selected_);
+    } else if (selected_ >= first_ + height_) {
+        this->scroll_to(selected_ + 1 - height_);
+    }
+}
+
+void PVTable::scroll_to(size_t row) {
+    const size_t last_first = rows_.size() > height_ ? rows_.size() - height_ : 0;
+    first_ = std::min(row, last_first);
+    this->update_window();
+}
+
+void PVTable::update_window() {
+    // a page of margin on both sides keeps scrolling by a row or a page from
+    // cancelling and restarting monitors on every step
+    const size_t begin = first_ > height_ ? first_ - height_ : 0;
+    const size_t end = std::min(rows_.size(), first_ + 2 * height_);
+    for (size_t i = active_begin_; i < active_end_; i++) {
+        if (i < begin || i >= end) {
+            rows_[i].subscription.set_active(false);
+        }
+    }
+    for (size_t i = begin; i < end; i++) {
+        rows_[i].subscription.set_active(true);
+    }
+    active_begin_ = begin;
+    active_end_ = end;
+}
+
+const ftxui::Element& PVTable::row_element(Row& row) {
+    const bool connected = row.pv->connected();
+    const uint64_t generation = row.pv->generation();
+    if (!row.element || generation != row.generation || connected != row.connected) {
+        ftxui::Decorator style = EPICSColor::WHITE_ON_WHITE;
+        if (connected) {
+            const bool failed = row.pv->conversion_failed(row.subscription.slot());
+            style = failed ? EPICSColor::INVALID : EPICSColor::READBACK;
+        }
+        using namespace ftxui;
+        row.element = hbox({
+            text(row.name) | color(Color::Black) | ftxui::size(WIDTH, EQUAL, name_width_),
+            separatorEmpty(),
+            text(row.value) | style | xflex,
+        });
+        row.generation = generation;
+        row.connected = connected;
+    }
+    return row.element;
+}
+
+ftxui::Element PVTable::render(bool focused) {
+    using namespace ftxui;
+    Elements lines;
+    const size_t end = std::min(rows_.size(), first_ + height_);
+    for (size_t i = first_; i < end; i++) {
+        const Element& line = this->row_element(rows_[i]);
+        lines.push_back(focused && i == selected_ ? line | inverted : line);
+    }
+    std::string position = "No PVs";
+    if (!rows_.empty()) {
+        position = std::to_string(first_ + 1) + "-" + std::to_string(end);
+        position += " of " + std::to_string(rows_.size());
+    }
+    return vbox({
+        vbox(std::move(lines)) | ftxui::size(HEIGHT, EQUAL, static_cast<int>(height_)),
+        text(position) | dim | align_right,
+    }) | reflect(box_);
+}
+
+bool PVTable::on_event(ftxui::Event event) {
+    using ftxui::Event;
+    if (rows_.empty()) {
+        return false;
+    }
+    // the wheel only scrolls the table under the pointer
+    const bool wheel = event.is_mouse() && box_.Contain(event.mouse().x, event.mouse().y);
+    if (event == Event::ArrowDown || (wheel && event.mouse().button == ftxui::Mouse::WheelDown)) {
+        this->select(selected_ + 1);
+    } else if (event == Event::ArrowUp || (wheel && event.mouse().button == ftxui::Mouse::WheelUp)) {
+        this->select(selected_ > 0 ? selected_ - 1 : 0);
+    } else if (event == Event::PageDown) {
+        this->select(selected_ + height_);
+    } else if (event == Event::PageUp) {
+        this->select(selected_ > height_ ? selected_ - height_ : 0);
+    } else if (event == Event::Home) {
+        this->select(0);
+    } else if (event == Event::End) {
+        this->select(rows_.size() - 1);
+    } else {
+        return false;
+    }
+    return true;
 }
 
 } // namespace pvtui
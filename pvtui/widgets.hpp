@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -7,6 +8,7 @@
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/component_options.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/box.hpp>
 #include <ftxui/screen/color.hpp>
 
 #include <pvtui/app.hpp>
@@ -77,6 +79,58 @@ class WidgetBase {
      */
     bool connected() const;
 
+    /**
+     * @brief Gets the status of the puts issued by the widget's PV.
+     *
+     * Input, button and choice widgets draw themselves in EPICSColor::INVALID while
+     * their PV is connected and its last put failed.
+     * @return The PutStatus as of the last PVGroup::sync().
+     */
+    const PutStatus& put_status() const;
+
+    /**
+     * @brief Gets the display metadata (precision, units, limits) of the widget's PV.
+     * @return The PV's cached PVMetadata.
+     */
+    std::shared_ptr<const PVMetadata> metadata() const;
+
+    /**
+     * @brief Checks if the widget's PV value could not be converted to the widget's monitored type.
+     *
+     * Other widgets monitoring the same PV as a type which fails don't affect this one.
+     * @return True if the last synced update failed to convert, false otherwise.
+     */
+    bool conversion_failed() const;
+
+    /**
+     * @brief Gets a counter which changes each time PVGroup::sync() updates the widget's PV.
+     * @return The PV's PVHandler::generation().
+     */
+    uint64_t generation() const;
+
+    /**
+     * @brief Gets the element made by build, calling it only when the widget's PV has changed.
+     *
+     * The last element is reused while the PV's generation() and connection state stay
+     * the same, so a renderer with many widgets only rebuilds those whose PV changed.
+     * build must therefore only depend on this widget, and the element should appear
+     * once per frame. Interactive components draw focus and hover state, so only
+     * display elements should be cached.
+     * @param build A callable returning the widget's ftxui::Element.
+     * @return The cached or newly built element.
+     */
+    template <typename Build>
+    ftxui::Element cached(Build&& build) const {
+        const bool is_connected = this->connected();
+        const uint64_t generation = this->generation();
+        if (!render_cache_ || generation != render_generation_ || is_connected != render_connected_) {
+            render_cache_ = build();
+            render_generation_ = generation;
+            render_connected_ = is_connected;
+        }
+        return render_cache_;
+    }
+
   protected:
     /**
      * @brief Constructs a WidgetBase and registers the PV with a PVGroup.
@@ -85,20 +139,43 @@ class WidgetBase {
      * @param pvgroup The PVGroup used to manage PVs for this widget.
      * @param args The ArgParser for macro expansion.
      * @param pv_name The macro-style PV name (e.g., "$(P)$(R)VAL").
+     * @param acquire Whether to acquire the PV. Widgets which monitor a value pass false
+     * and call subscribe() instead, so the PV is claimed only once.
      */
-    WidgetBase(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name);
+    WidgetBase(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name, bool acquire = true);
 
     /**
      * @brief Constructs a WidgetBase with a fully-expanded PV name.
      * @param pvgroup The PVGroup used to manage PVs for this widget.
      * @param pv_name The fully-expanded PV name.
+     * @param acquire Whether to acquire the PV, see above.
      */
-    WidgetBase(PVGroup& pvgroup, const std::string& pv_name);
+    WidgetBase(PVGroup& pvgroup, const std::string& pv_name, bool acquire = true);
+
+    /**
+     * @brief Subscribes the widget's PV to a variable, for widgets constructed without acquiring it.
+     * @param var The variable the widget displays. Must outlive the widget's Subscription.
+     */
+    template <typename T>
+    void subscribe(T& var) {
+        subscription_ = pvgroup_.subscribe(pv_name_, var);
+        this->attach();
+    }
 
     PVGroup& pvgroup_;                                      ///< The PVGroup
     std::string pv_name_;                                   ///< The PV name.
+    Subscription subscription_;                             ///< Keeps the PV and monitored value registered.
+    std::shared_ptr<PVHandler> pv_;                         ///< The widget's PV.
     ftxui::Component component_;                            ///< Underlying FTXUI component.
     std::shared_ptr<ConnectionMonitor> connection_monitor_; ///< Monitors PV connection status.
+
+  private:
+    /// @brief Looks up the PV the Subscription was taken for.
+    void attach();
+
+    mutable ftxui::Element render_cache_;    ///< Element returned by cached().
+    mutable uint64_t render_generation_ = 0; ///< PV generation render_cache_ was built at.
+    mutable bool render_connected_ = false;  ///< Connection state render_cache_ was built with.
 };
 
 /**
@@ -164,9 +241,11 @@ class ButtonWidget : public WidgetBase {
      * @param pv_name The PV name with macros, e.g. "$(P)$(M).VAL".
      * @param label The text displayed on the button.
      * @param press_val The value written to the PV on press.
+     * @param policy How presses made while a put is in flight are combined. By default every
+     * press is sent.
      */
     ButtonWidget(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name,
-                 const std::string& label, int press_val = 1);
+                 const std::string& label, int press_val = 1, PutPolicy policy = PutPolicy::KeepAll);
 
     /**
      * @brief Constructs a ButtonWidget with an expanded PV name.
@@ -174,8 +253,11 @@ class ButtonWidget : public WidgetBase {
      * @param pv_name The PV name.
      * @param label The text displayed on the button.
      * @param press_val The value written to the PV on press.
+     * @param policy How presses made while a put is in flight are combined. By default every
+     * press is sent.
      */
-    ButtonWidget(PVGroup& pvgroup, const std::string& pv_name, const std::string& label, int press_val = 1);
+    ButtonWidget(PVGroup& pvgroup, const std::string& pv_name, const std::string& label, int press_val = 1,
+                 PutPolicy policy = PutPolicy::KeepAll);
 
     /**
      * @brief Constructs a ButtonWidget from an App class
@@ -183,8 +265,11 @@ class ButtonWidget : public WidgetBase {
      * @param pv_name The PV name.
      * @param label The text displayed on the button.
      * @param press_val The value written to the PV on press.
+     * @param policy How presses made while a put is in flight are combined. By default every
+     * press is sent.
      */
-    ButtonWidget(App& app, const std::string& pv_name, const std::string& label, int press_val = 1);
+    ButtonWidget(App& app, const std::string& pv_name, const std::string& label, int press_val = 1,
+                 PutPolicy policy = PutPolicy::KeepAll);
 };
 
 /**
@@ -204,8 +289,8 @@ class Monitor : public WidgetBase {
      * @param pv_name The PV name with macros, e.g. "$(P)$(M).VAL".
      */
     Monitor(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name)
-        : WidgetBase(pvgroup, args, pv_name), value_ptr_(std::make_shared<T>()) {
-        pvgroup.set_monitor(pv_name_, *value_ptr_);
+        : WidgetBase(pvgroup, args, pv_name, false), value_ptr_(std::make_shared<T>()) {
+        this->subscribe(*value_ptr_);
     }
 
     /**
@@ -214,8 +299,8 @@ class Monitor : public WidgetBase {
      * @param pv_name The PV name.
      */
     Monitor(PVGroup& pvgroup, const std::string& pv_name)
-        : WidgetBase(pvgroup, pv_name), value_ptr_(std::make_shared<T>()) {
-        pvgroup.set_monitor(pv_name_, *value_ptr_);
+        : WidgetBase(pvgroup, pv_name, false), value_ptr_(std::make_shared<T>()) {
+        this->subscribe(*value_ptr_);
     }
 
     /**
@@ -224,8 +309,8 @@ class Monitor : public WidgetBase {
      * @param pv_name The PV name.
      */
     Monitor(App& app, const std::string& pv_name)
-        : WidgetBase(app.pvgroup, app.args, pv_name), value_ptr_(std::make_shared<T>()) {
-        app.pvgroup.set_monitor(pv_name_, *value_ptr_);
+        : WidgetBase(app.pvgroup, app.args, pv_name, false), value_ptr_(std::make_shared<T>()) {
+        this->subscribe(*value_ptr_);
     }
 
     /**
@@ -237,19 +322,22 @@ class Monitor : public WidgetBase {
     /**
      * @brief Renders
      * @return An valid FTXUI component which renders the monitored value as ftxui::text,
-     * proving it can be converted to std::string with std::to_string.
+     * proving it can be converted to std::string with std::to_string. The text is only
+     * rebuilt when the PV changes.
      */
     ftxui::Component component() const {
         return ftxui::Renderer([this] {
-            if constexpr (std::is_same_v<T, std::string>) {
-                return ftxui::text(*value_ptr_);
-            } else if constexpr (std::is_arithmetic_v<T>) {
-                return ftxui::text(std::to_string(*value_ptr_));
-            } else if constexpr (std::is_same_v<T, PVEnum>) {
-                return ftxui::text(value_ptr_->choice);
-            } else {
-                return ftxui::text("<" + this->pv_name() + ">");
-            }
+            return this->cached([this] {
+                if constexpr (std::is_same_v<T, std::string>) {
+                    return ftxui::text(*value_ptr_);
+                } else if constexpr (std::is_arithmetic_v<T>) {
+                    return ftxui::text(std::to_string(*value_ptr_));
+                } else if constexpr (std::is_same_v<T, PVEnum>) {
+                    return ftxui::text(value_ptr_->choice());
+                } else {
+                    return ftxui::text("<" + this->pv_name() + ">");
+                }
+            });
         });
     }
 
@@ -310,24 +398,33 @@ class ChoiceWidget : public WidgetBase {
      * @param args ArgParser for macro replacement.
      * @param pv_name The PV name with macros, e.g. "$(P)$(M).VAL".
      * @param style Layout style (vertical, horizontal, dropdown).
+     * @param policy How selections made while a put is in flight are combined. By default
+     * only the newest selection is sent.
      */
-    ChoiceWidget(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name, ChoiceStyle style);
+    ChoiceWidget(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name, ChoiceStyle style,
+                 PutPolicy policy = PutPolicy::LastValue);
 
     /**
      * @brief Constructs a ChoiceWidget with a PV name without macros.
      * @param pvgroup The PVGroup managing the PVs used in this widget.
      * @param pv_name The PV name.
      * @param style Layout style (vertical, horizontal, dropdown).
+     * @param policy How selections made while a put is in flight are combined. By default
+     * only the newest selection is sent.
      */
-    ChoiceWidget(PVGroup& pvgroup, const std::string& pv_name, ChoiceStyle style);
+    ChoiceWidget(PVGroup& pvgroup, const std::string& pv_name, ChoiceStyle style,
+                 PutPolicy policy = PutPolicy::LastValue);
 
     /**
      * @brief Constructs a ChoiceWidget from an App class
      * @param app A reference to the App.
      * @param pv_name The PV name.
      * @param style Layout style (vertical, horizontal, dropdown).
+     * @param policy How selections made while a put is in flight are combined. By default
+     * only the newest selection is sent.
      */
-    ChoiceWidget(App& app, const std::string& pv_name, ChoiceStyle style);
+    ChoiceWidget(App& app, const std::string& pv_name, ChoiceStyle style,
+                 PutPolicy policy = PutPolicy::LastValue);
 
     /**
      * @brief Gets the current enum value displayed in the UI.
@@ -339,6 +436,115 @@ class ChoiceWidget : public WidgetBase {
     std::shared_ptr<PVEnum> value_ptr_;
 };
 
+/**
+ * @brief A scrolling list of read-only PV rows which only monitors the rows near the screen.
+ *
+ * Each row shows a PV name and its value as a string. Only rows within a page of
+ * the visible window are monitored; the others have their Subscriptions
+ * deactivated, so their monitors are cancelled unless another widget uses the
+ * PV, and PVs never scrolled near are never connected. A frame only builds the
+ * visible rows and PVGroup::sync() only visits monitored ones, so both cost the
+ * same for ten rows as for ten thousand. Rows are managed by the table itself and
+ * are not activated or deactivated with a DisplayBase.
+ *
+ * The arrow keys and mouse wheel move the selected row by one, page up and page
+ * down by the height of the table, and home and end jump to the first and last row.
+ */
+class PVTable {
+  public:
+    /**
+     * @brief Constructs a PVTable with fully expanded PV names.
+     * @param pvgroup The PVGroup managing the PVs used in this widget.
+     * @param pv_names The PV of each row.
+     * @param height The number of rows shown at once.
+     */
+    PVTable(PVGroup& pvgroup, const std::vector<std::string>& pv_names, size_t height = 20);
+
+    /**
+     * @brief Constructs a PVTable from an App class, expanding macros in the PV names.
+     * @param app A reference to the App.
+     * @param pv_names The PV of each row, e.g. "$(P)m1.RBV".
+     * @param height The number of rows shown at once.
+     */
+    PVTable(App& app, const std::vector<std::string>& pv_names, size_t height = 20);
+
+    PVTable(const PVTable&) = delete;
+    PVTable& operator=(const PVTable&) = delete;
+
+    /**
+     * @brief Gets the FTXUI component which renders the visible rows and handles scrolling.
+     * @return A focusable FTXUI component.
+     */
+    ftxui::Component component() const { return component_; }
+
+    /// @brief Gets the number of rows.
+    size_t size() const { return rows_.size(); }
+
+    /// @brief Gets the number of rows shown at once.
+    size_t height() const { return height_; }
+
+    /// @brief Gets the index of the first visible row.
+    size_t first_row() const { return first_; }
+
+    /// @brief Gets the index of the selected row.
+    size_t selected_row() const { return selected_; }
+
+    /// @brief Gets the PV name of a row, which must be less than size().
+    const std::string& pv_name(size_t row) const { return rows_[row].name; }
+
+    /// @brief Gets the last value received for a row, which must be less than size().
+    const std::string& value(size_t row) const { return rows_[row].value; }
+
+    /// @brief Checks if a row's PV is currently monitored for the table.
+    bool monitored(size_t row) const { return rows_[row].subscription.active(); }
+
+    /**
+     * @brief Selects a row, scrolling the least needed to show it.
+     * @param row The row to select, clamped to the last row.
+     */
+    void select(size_t row);
+
+    /**
+     * @brief Scrolls so that a row is the first visible one, or as close as the end of the table allows.
+     * @param row The row to show first.
+     */
+    void scroll_to(size_t row);
+
+  private:
+    /// @brief One PV of the table.
+    struct Row {
+        std::string name;                ///< The PV name.
+        std::string value;               ///< The PV value, updated while subscription is active.
+        Subscription subscription;       ///< Registers value, activated near the visible window.
+        std::shared_ptr<PVHandler> pv;   ///< The row's PV.
+        ftxui::Element element;          ///< Rendered row, reused until the PV changes.
+        uint64_t generation = 0;         ///< PV generation element was built at.
+        bool connected = false;          ///< Connection state element was built with.
+    };
+
+    /// @brief Activates the rows within a page of the visible window and deactivates the others.
+    void update_window();
+
+    /// @brief Builds the visible rows and a position line.
+    ftxui::Element render(bool focused);
+
+    /// @brief Gets a row's element, rebuilding it if its PV changed.
+    const ftxui::Element& row_element(Row& row);
+
+    /// @brief Moves the selection on arrow, page, home, end and mouse wheel events over the table.
+    bool on_event(ftxui::Event event);
+
+    std::vector<Row> rows_;      ///< Sized once, so the addresses of row values stay valid.
+    size_t height_;              ///< Rows shown at once.
+    size_t first_ = 0;           ///< First visible row.
+    size_t selected_ = 0;        ///< Selected row.
+    size_t active_begin_ = 0;    ///< First monitored row.
+    size_t active_end_ = 0;      ///< One past the last monitored row.
+    int name_width_ = 0;         ///< Width of the name column.
+    ftxui::Box box_;             ///< Screen area of the table, set by render().
+    ftxui::Component component_; ///< Renders the table and handles scrolling.
+};
+
 /**
  * @brief Functions to generate FTXUI decorators for EPICS-style UI elements.
  * To align stylistically with MEDM, caQtDM etc, when PVs are disconnected, the widget
@@ -349,37 +555,42 @@ namespace EPICSColor {
 /// @brief White foreground and background for disconnected widgets
 static const ftxui::Decorator WHITE_ON_WHITE = bgcolor(ftxui::Color::White) | color(ftxui::Color::White);
 
+/// @brief White text on magenta, the INVALID alarm color, for values that can't be displayed
+static const ftxui::Decorator INVALID = bgcolor(ftxui::Color::Magenta) | color(ftxui::Color::White);
+
 /// @brief Light blue with black text for editable controls
-inline ftxui::Decorator edit(const WidgetBase& w) {
-    return w.connected() ? ftxui::bgcolor(ftxui::Color::RGB(87, 202, 228)) | ftxui::color(ftxui::Color::Black)
-                         : WHITE_ON_WHITE;
-}
+static const ftxui::Decorator EDIT = bgcolor(ftxui::Color::RGB(87, 202, 228)) | color(ftxui::Color::Black);
 
 /// @brief Dark green with white text for "related display" menus
-inline ftxui::Decorator menu(const WidgetBase& w) {
-    return w.connected() ? ftxui::bgcolor(ftxui::Color::RGB(16, 105, 25)) | ftxui::color(ftxui::Color::White)
-                         : WHITE_ON_WHITE;
-}
+static const ftxui::Decorator MENU = bgcolor(ftxui::Color::RGB(16, 105, 25)) | color(ftxui::Color::White);
 
 /// @brief Dark blue text on gray background for readbacks
-inline ftxui::Decorator readback(const WidgetBase& w) {
-    return w.connected()
-               ? ftxui::bgcolor(ftxui::Color::RGB(196, 196, 196)) | ftxui::color(ftxui::Color::DarkBlue)
-               : WHITE_ON_WHITE;
-}
+static const ftxui::Decorator READBACK =
+    bgcolor(ftxui::Color::RGB(196, 196, 196)) | color(ftxui::Color::DarkBlue);
 
 /// @brief Pinkish/purple with black text for links
-inline ftxui::Decorator link(const WidgetBase& w) {
-    return w.connected()
-               ? ftxui::bgcolor(ftxui::Color::RGB(148, 148, 228)) | ftxui::color(ftxui::Color::Black)
-               : WHITE_ON_WHITE;
-}
+static const ftxui::Decorator LINK = bgcolor(ftxui::Color::RGB(148, 148, 228)) | color(ftxui::Color::Black);
 
 /// @brief A custom color
 inline ftxui::Decorator custom(const WidgetBase& w, ftxui::Decorator style) {
-    return w.connected() ? style : WHITE_ON_WHITE;
+    if (!w.connected()) {
+        return WHITE_ON_WHITE;
+    }
+    return w.conversion_failed() ? INVALID : style;
 }
 
+/// @brief Light blue with black text for editable controls
+inline ftxui::Decorator edit(const WidgetBase& w) { return custom(w, EDIT); }
+
+/// @brief Dark green with white text for "related display" menus
+inline ftxui::Decorator menu(const WidgetBase& w) { return custom(w, MENU); }
+
+/// @brief Dark blue text on gray background for readbacks
+inline ftxui::Decorator readback(const WidgetBase& w) { return custom(w, READBACK); }
+
+/// @brief Pinkish/purple with black text for links
+inline ftxui::Decorator link(const WidgetBase& w) { return custom(w, LINK); }
+
 /// @brief Default gray background color
 inline ftxui::Decorator background() { return ftxui::bgcolor(ftxui::Color::RGB(196, 196, 196)); }
 } // namespace EPICSColor
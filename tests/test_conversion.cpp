@@ -0,0 +1,68 @@
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Monitors a string PV as a double and checks that a value which doesn't convert
+// is reported through conversion_failed() instead of stopping the program, only
+// for the widgets of that type, and that the PV recovers once it holds a number again.
+
+namespace pvd = epics::pvData;
+
+using pvtui::test::sync_until;
+
+int main() {
+
+    std::cout << "[pvtui::MonitorSlots] Running conversion failure tests...\n";
+
+    const std::string pv_name = "pvtui:conv:desc";
+
+    pvtui::test::TestServer server("pvtui_conversion", pvd::pvString);
+    server.set(std::string("not a number"));
+    auto shared_pv = server.add(pv_name);
+
+    pvac::ClientProvider provider = server.client();
+    pvtui::PVGroup pvgroup(provider, {pv_name});
+    pvtui::PVHandler& pv = pvgroup.get_pv(pv_name);
+
+    double number = 42.0;
+    std::string text;
+    pvgroup.set_monitor(pv_name, number);
+    pvgroup.set_monitor(pv_name, text);
+
+    // Widgets on the same PV, one of each type
+    pvtui::Monitor<double> number_widget(pvgroup, pv_name);
+    pvtui::Monitor<std::string> text_widget(pvgroup, pv_name);
+
+    // The string slot updates, the double slot fails and keeps its value
+    bool synced = sync_until(pvgroup, [&] { return text == "not a number"; });
+    assert(synced);
+    assert(pv.conversion_failed());
+    assert(pv.conversion_failed(pvtui::MonitorSlots::slot_index<double>()));
+    assert(!pv.conversion_failed(pvtui::MonitorSlots::slot_index<std::string>()));
+    assert(number == 42.0);
+
+    // Only the widget whose type fails is reported, the other one shows its text
+    synced = sync_until(pvgroup, [&] { return text_widget.value() == "not a number"; });
+    assert(synced);
+    assert(number_widget.conversion_failed());
+    assert(!text_widget.conversion_failed());
+    assert(pv.conversion_errors() >= 1);
+    assert(pvgroup.conversion_errors() == pv.conversion_errors());
+
+    // A numeric string converts again and clears the failure
+    server.set(std::string("1.5"));
+    server.post(shared_pv);
+    synced = sync_until(pvgroup, [&] { return text == "1.5"; });
+    assert(synced);
+    assert(!pv.conversion_failed());
+    assert(number == 1.5);
+    synced = sync_until(pvgroup, [&] { return number_widget.value() == 1.5; });
+    assert(synced);
+    assert(!number_widget.conversion_failed());
+
+    std::cout << "[pvtui::MonitorSlots] All tests passed" << std::endl;
+}
@@ -0,0 +1,91 @@
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <pvtui/display_base.hpp>
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Checks that a DisplayBase deactivated before the first sync() never connects its
+// PVs, that a widget created after it doesn't belong to it, that activate() and
+// deactivate() start and stop its monitors, and that a PV shared with another
+// active display keeps updating.
+
+namespace {
+
+using pvtui::test::sync_until;
+
+class TestDisplay : public pvtui::DisplayBase {
+  public:
+    TestDisplay(pvtui::PVGroup& pvgroup, const std::string& shared_name, const std::string& own_name)
+        : pvtui::DisplayBase(pvgroup), shared(pvgroup, shared_name), own(pvgroup, own_name) {
+        end_construction();
+    }
+    ftxui::Element get_renderer() override { return ftxui::text(""); }
+    ftxui::Component get_container() override { return ftxui::Container::Vertical({}); }
+
+    pvtui::Monitor<double> shared;
+    pvtui::Monitor<double> own;
+};
+
+} // namespace
+
+int main() {
+
+    std::cout << "[pvtui::DisplayBase] Running activation tests...\n";
+
+    const std::string shared_name = "pvtui:act:shared";
+    const std::string a_name = "pvtui:act:a";
+    const std::string b_name = "pvtui:act:b";
+    const std::string later_name = "pvtui:act:later";
+
+    pvtui::test::TestServer server("pvtui_activation");
+    server.set(1.0);
+    auto shared_pv = server.add(shared_name);
+    auto a_pv = server.add(a_name);
+    auto b_pv = server.add(b_name);
+    server.add(later_name);
+
+    pvac::ClientProvider provider = server.client();
+    pvtui::PVGroup pvgroup(provider);
+
+    TestDisplay a(pvgroup, shared_name, a_name);
+    TestDisplay b(pvgroup, shared_name, b_name);
+    // created after the displays, so it belongs to neither of them
+    pvtui::Monitor<double> later(pvgroup, later_name);
+    b.deactivate();
+    assert(a.active() && !b.active());
+
+    // Only the active display connects and receives data
+    bool synced = sync_until(pvgroup, [&] { return a.shared.value() == 1.0 && a.own.value() == 1.0; });
+    assert(synced);
+    synced = sync_until(pvgroup, [&] { return later.value() == 1.0; });
+    assert(synced);
+    assert(!b.own.connected());
+    assert(b.own.value() == 0.0);
+
+    // Activating connects the hidden display's PVs
+    b.activate();
+    synced = sync_until(pvgroup, [&] { return b.shared.value() == 1.0 && b.own.value() == 1.0; });
+    assert(synced);
+
+    // The shared PV keeps updating while one of its displays is active
+    a.deactivate();
+    server.set(2.0);
+    server.post(shared_pv);
+    server.post(a_pv);
+    server.post(b_pv);
+    synced = sync_until(pvgroup, [&] { return b.shared.value() == 2.0 && b.own.value() == 2.0; });
+    assert(synced);
+    assert(a.shared.value() == 2.0);
+
+    // The inactive display's own PV no longer updates
+    synced = sync_until(pvgroup, [&] { return a.own.value() == 2.0; }, std::chrono::milliseconds(500));
+    assert(!synced);
+    assert(a.own.value() == 1.0);
+
+    std::cout << "[pvtui::DisplayBase] All tests passed" << std::endl;
+}
@@ -0,0 +1,105 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Checks that a traced update is timed from its timeStamp through sync() to
+// PVGroup::frame_drawn(), that the initial value is left out of the stages which
+// start at the timeStamp, and that the trace file lists the update's events.
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+using pvtui::test::sync_until;
+
+void set_timestamp(pvd::PVStructure& value, std::chrono::system_clock::time_point time) {
+    const auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    value.getSubFieldT<pvd::PVLong>("timeStamp.secondsPastEpoch")->put(ns / 1000000000);
+    value.getSubFieldT<pvd::PVInt>("timeStamp.nanoseconds")->put(static_cast<pvd::int32>(ns % 1000000000));
+}
+
+} // namespace
+
+int main() {
+
+    std::cout << "[pvtui::PVGroup] Running latency trace tests...\n";
+
+    using std::chrono::milliseconds;
+    const std::string pv_name = "pvtui:trace:rbv";
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "pvtui_test_latency_trace.json").string();
+
+    pvtui::test::TestServer server("pvtui_test_latency_trace", pvtui::test::scalar_type(pvd::pvDouble, true));
+    server.set(1.0);
+    // the initial value's timeStamp is an hour old, which must not count as latency
+    set_timestamp(*server.value, std::chrono::system_clock::now() - std::chrono::hours(1));
+    server.changed.set(server.value->getSubFieldT<pvd::PVStructure>("timeStamp")->getFieldOffset());
+    auto pv = server.add(pv_name);
+
+    pvac::ClientProvider provider = server.client();
+    {
+        pvtui::PVGroup pvgroup(provider);
+        pvgroup.trace_to_file(path);
+        const pvtui::LatencyStages& stages = pvgroup.latency();
+
+        double var = -1.0;
+        auto sub = pvgroup.subscribe(pv_name, var);
+        sub.set_active(true);
+        bool synced = sync_until(pvgroup, [&] { return var == 1.0; });
+        assert(synced);
+        pvgroup.frame_drawn();
+        assert(stages.callback_to_sync.snapshot().count == 1);
+        assert(stages.sync_to_paint.snapshot().count == 1);
+        assert(stages.source_to_callback.snapshot().count == 0);
+        assert(stages.source_to_paint.snapshot().count == 0);
+
+        // nothing was synced since the last frame
+        pvgroup.frame_drawn();
+        assert(stages.sync_to_paint.snapshot().count == 1);
+
+        server.set(2.0);
+        set_timestamp(*server.value, std::chrono::system_clock::now() - milliseconds(50));
+        server.post(pv);
+        synced = sync_until(pvgroup, [&] { return var == 2.0; });
+        assert(synced);
+        pvgroup.frame_drawn();
+
+        const auto source_to_callback = stages.source_to_callback.snapshot();
+        const auto source_to_paint = stages.source_to_paint.snapshot();
+        assert(source_to_callback.count == 1);
+        assert(source_to_callback.percentile(0.0) >= milliseconds(50));
+        assert(source_to_paint.count == 1);
+        assert(source_to_paint.percentile(0.0) >= source_to_callback.percentile(0.0));
+        assert(stages.callback_to_sync.snapshot().count == 2);
+        assert(stages.sync_to_paint.snapshot().count == 2);
+
+        const auto metrics = pvgroup.pv_metrics();
+        assert(metrics.size() == 1);
+        assert(metrics[0].latency);
+        assert(metrics[0].latency->name == pv_name);
+        assert(metrics[0].latency->source_to_paint.snapshot().count == 1);
+    }
+
+    // the trace file is complete once the group is destroyed
+    std::ifstream file(path);
+    const std::string trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    assert(trace.front() == '[');
+    assert(trace.find("\"" + pv_name + "\"") != std::string::npos);
+    assert(trace.find("\"network\"") != std::string::npos);
+    assert(trace.find("\"queued\"") != std::string::npos);
+    assert(trace.find("\"frame\"") != std::string::npos);
+    file.close();
+    std::remove(path.c_str());
+
+    std::cout << "[pvtui::PVGroup] All tests passed" << std::endl;
+}
@@ -0,0 +1,112 @@
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Checks that PVHandler::metadata() is read from the first monitor update and is
+// only replaced when an update changes the display or control fields.
+
+namespace pvd = epics::pvData;
+
+using pvtui::test::sync_until;
+
+int main() {
+
+    std::cout << "[pvtui::PVMetadata] Running metadata tests...\n";
+
+    const std::string pv_name = "pvtui:meta:rbv";
+
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTScalar:1.0")
+                    ->add("value", pvd::pvDouble)
+                    ->addNestedStructure("display")
+                    ->add("limitLow", pvd::pvDouble)
+                    ->add("limitHigh", pvd::pvDouble)
+                    ->add("units", pvd::pvString)
+                    ->add("format", pvd::pvString)
+                    ->endNested()
+                    ->addNestedStructure("control")
+                    ->add("limitLow", pvd::pvDouble)
+                    ->add("limitHigh", pvd::pvDouble)
+                    ->endNested()
+                    ->createStructure();
+    pvtui::test::TestServer server("pvtui_meta", type);
+    const auto& value = server.value;
+    auto pval = value->getSubFieldT<pvd::PVDouble>("value");
+    auto format = value->getSubFieldT<pvd::PVString>("display.format");
+    value->getSubFieldT<pvd::PVString>("display.units")->put("mm");
+    value->getSubFieldT<pvd::PVDouble>("display.limitLow")->put(-10.0);
+    value->getSubFieldT<pvd::PVDouble>("display.limitHigh")->put(10.0);
+    value->getSubFieldT<pvd::PVDouble>("control.limitLow")->put(-5.0);
+    value->getSubFieldT<pvd::PVDouble>("control.limitHigh")->put(5.0);
+    format->put("F8.2");
+
+    auto shared_pv = server.add(pv_name);
+
+    pvac::ClientProvider provider = server.client();
+    pvtui::PVGroup pvgroup(provider, {pv_name});
+    pvtui::PVHandler& pv = pvgroup.get_pv(pv_name);
+
+    // Before set_monitor() so the monitor is only started once
+    pv.monitor_metadata();
+    std::string rbv;
+    pvgroup.set_monitor(pv_name, rbv);
+
+    // Populated from the first update
+    bool synced = sync_until(pvgroup, [&] { return rbv == "0.00"; });
+    assert(synced);
+    auto meta = pv.metadata();
+    assert(meta->precision == 2);
+    assert(meta->units == "mm");
+    assert(meta->display_low == -10.0 && meta->display_high == 10.0);
+    assert(meta->control_low == -5.0 && meta->control_high == 5.0);
+    std::cout << "  initial metadata: OK\n";
+
+    // Value-only updates reuse the cached metadata
+    pvd::BitSet value_changed;
+    value_changed.set(pval->getFieldOffset());
+    pval->put(1.5);
+    shared_pv->post(*value, value_changed);
+    synced = sync_until(pvgroup, [&] { return rbv == "1.50"; });
+    assert(synced);
+    assert(pv.metadata() == meta);
+    std::cout << "  value update keeps cache: OK\n";
+
+    // A display change refreshes it
+    pvd::BitSet format_changed;
+    format_changed.set(format->getFieldOffset());
+    format_changed.set(pval->getFieldOffset());
+    format->put("F8.4");
+    pval->put(2.0);
+    shared_pv->post(*value, format_changed);
+    synced = sync_until(pvgroup, [&] { return rbv == "2.0000"; });
+    assert(synced);
+    assert(pv.metadata() != meta);
+    assert(pv.metadata()->precision == 4);
+    assert(pv.metadata()->units == "mm");
+    std::cout << "  display update refreshes cache: OK\n";
+
+    // Identical enum labels share one table
+    auto table_a = pvtui::ChoiceTable::intern({"Off", "On"});
+    auto table_b = pvtui::ChoiceTable::intern({"Off", "On"});
+    auto table_c = pvtui::ChoiceTable::intern({"Off", "On", "Auto"});
+    assert(table_a == table_b);
+    assert(&table_a.labels() == &table_b.labels());
+    assert(table_a != table_c);
+    assert(table_c.size() == 3 && table_c[2] == "Auto");
+
+    pvtui::PVEnum penum;
+    assert(penum.choices.empty() && penum.choice().empty());
+    penum.choices = table_c;
+    penum.index = 1;
+    assert(penum.choice() == "On");
+    penum.index = 5;
+    assert(penum.choice().empty());
+    std::cout << "  interned choice tables: OK\n";
+
+    std::cout << "[pvtui::PVMetadata] All tests passed" << std::endl;
+}
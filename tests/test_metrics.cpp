@@ -0,0 +1,109 @@
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Checks the bucketing and percentiles of LatencyHistogram, and that a PVGroup
+// counts the monitor events of its PVs and times its syncs.
+
+namespace {
+
+// Checks that a percentile is no lower than expected and at most 1/8 above it
+bool close_to(std::chrono::nanoseconds actual, std::chrono::nanoseconds expected) {
+    return actual >= expected && actual <= expected + expected / 8;
+}
+
+void test_buckets() {
+    for (uint64_t ns = 0; ns < pvtui::LatencyHistogram::SUB_BUCKETS; ns++) {
+        assert(pvtui::LatencyHistogram::bucket(ns) == ns);
+        assert(pvtui::LatencyHistogram::bucket_max(ns) == ns);
+    }
+    size_t prev = 0;
+    for (uint64_t ns = 1; ns < (uint64_t{1} << 62); ns = ns * 3 / 2 + 1) {
+        const size_t b = pvtui::LatencyHistogram::bucket(ns);
+        assert(b < pvtui::LatencyHistogram::NUM_BUCKETS);
+        assert(b >= prev);
+        assert(pvtui::LatencyHistogram::bucket_max(b) >= ns);
+        assert(pvtui::LatencyHistogram::bucket_max(b) - ns <= ns / 8);
+        prev = b;
+    }
+    const uint64_t max = std::numeric_limits<uint64_t>::max();
+    assert(pvtui::LatencyHistogram::bucket(max) == pvtui::LatencyHistogram::NUM_BUCKETS - 1);
+    assert(pvtui::LatencyHistogram::bucket_max(pvtui::LatencyHistogram::NUM_BUCKETS - 1) == max);
+}
+
+void test_percentiles() {
+    using std::chrono::microseconds;
+    pvtui::LatencyHistogram hist;
+    assert(hist.snapshot().stats().count == 0);
+    assert(hist.snapshot().percentile(0.5).count() == 0);
+
+    for (int us = 1; us <= 1000; us++) {
+        hist.record(microseconds(us));
+    }
+    hist.record(std::chrono::nanoseconds(-5));
+    const auto first = hist.snapshot();
+    assert(first.count == 1001);
+    const pvtui::DurationStats stats = first.stats();
+    assert(close_to(stats.p50, microseconds(500)));
+    assert(close_to(stats.p99, microseconds(990)));
+    assert(close_to(stats.max, microseconds(1000)));
+    assert(stats.mean > microseconds(499) && stats.mean < microseconds(501));
+
+    // the difference of two snapshots only holds what was recorded in between
+    for (int i = 0; i < 10; i++) {
+        hist.record(std::chrono::milliseconds(50));
+    }
+    auto second = hist.snapshot();
+    second -= first;
+    assert(second.count == 10);
+    assert(close_to(second.percentile(0.0), std::chrono::milliseconds(50)));
+    assert(second.stats().mean == std::chrono::milliseconds(50));
+}
+
+} // namespace
+
+int main() {
+
+    std::cout << "[pvtui::LatencyHistogram] Running metrics tests...\n";
+
+    test_buckets();
+    test_percentiles();
+
+    const std::string pv_name = "pvtui:metrics:a";
+    pvtui::test::TestServer server("pvtui_metrics");
+    auto pv = server.add(pv_name);
+
+    pvac::ClientProvider provider = server.client();
+    pvtui::PVGroup pvgroup(provider);
+    double var = -1.0;
+    auto sub = pvgroup.subscribe(pv_name, var);
+    sub.set_active(true);
+
+    for (int i = 0; i < 10; i++) {
+        server.set(static_cast<double>(i));
+        server.post(pv);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (var != 9.0) {
+        assert(std::chrono::steady_clock::now() < deadline);
+        pvgroup.wait_for_data(std::chrono::milliseconds(100));
+        pvgroup.sync();
+    }
+
+    const auto metrics = pvgroup.pv_metrics();
+    assert(metrics.size() == 1);
+    assert(metrics[0].name == pv_name);
+    assert(metrics[0].connected);
+    assert(metrics[0].monitor_events >= 1);
+    assert(metrics[0].monitor_events == pvgroup.get_pv(pv_name).monitor_events());
+    assert(metrics[0].dropped_updates < metrics[0].monitor_events);
+    assert(pvgroup.sync_time().snapshot().count > 0);
+
+    std::cout << "[pvtui::LatencyHistogram] All tests passed" << std::endl;
+}
@@ -0,0 +1,118 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Hammers a single PV from an in-process pvAccess server while the main thread
+// calls PVGroup::sync() continuously. Checks that the producer and sync() never
+// observe torn or out of order values and that the newest value is delivered.
+// Then queues a few updates while nothing polls the monitor and checks that all
+// but the newest are dropped.
+
+namespace pvtui {
+
+struct MonitorTestAccess {
+    // The in-process server calls back on the posting thread, which polls at once.
+    // While monitor_started_ is clear the callback returns without polling, so
+    // pvAccess queues the updates and doesn't call back again until polled.
+    static void hold_polling(PVHandler& pv) {
+        const std::lock_guard<std::mutex> lock(pv.monitor_mutex_);
+        pv.monitor_started_ = false;
+    }
+
+    static void release_polling(PVHandler& pv) {
+        {
+            const std::lock_guard<std::mutex> lock(pv.monitor_mutex_);
+            pv.monitor_started_ = true;
+        }
+        pv.poll_monitor();
+    }
+};
+
+} // namespace pvtui
+
+using pvtui::test::sync_until;
+
+int main() {
+
+    std::cout << "[pvtui::PVHandler] Running monitor stress test...\n";
+
+    constexpr int N_UPDATES = 200000;
+    const std::string pv_name = "pvtui:stress:counter";
+
+    // Local server with a single NTScalar double
+    pvtui::test::TestServer server("pvtui_stress");
+    server.set(-1.0);
+    auto shared_pv = server.add(pv_name);
+
+    // Client side, connected to the server in-process
+    pvac::ClientProvider provider = server.client();
+    pvtui::PVGroup pvgroup(provider, {pv_name});
+
+    double counter = -1.0;
+    std::string counter_str;
+    pvgroup.set_monitor(pv_name, counter);
+    pvgroup.set_monitor(pv_name, counter_str);
+
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        for (int i = 0; i < N_UPDATES; i++) {
+            server.set(static_cast<double>(i));
+            server.post(shared_pv);
+        }
+        done.store(true);
+    });
+
+    size_t n_syncs = 0;
+    size_t n_updates = 0;
+    double last = -1.0;
+    char expected[64];
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    while (!(done.load() && last == N_UPDATES - 1)) {
+        if (pvgroup.sync()) {
+            n_updates++;
+            // values only move forward and all slots come from the same update
+            assert(counter >= last);
+            std::snprintf(expected, sizeof(expected), "%.4f", counter);
+            assert(counter_str == expected);
+            last = counter;
+        }
+        n_syncs++;
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cerr << "Timed out waiting for last update, got " << last << "\n";
+            producer.join();
+            return EXIT_FAILURE;
+        }
+    }
+    producer.join();
+
+    pvtui::PVHandler& pv = pvgroup.get_pv(pv_name);
+    const size_t dropped = pv.dropped_updates();
+    assert(dropped < static_cast<size_t>(N_UPDATES));
+    assert(pvgroup.dropped_updates() == dropped);
+
+    std::cout << "  " << N_UPDATES << " posts, " << n_syncs << " syncs, " << n_updates
+              << " synced updates, " << dropped << " dropped\n";
+
+    // updates queued behind a newer one are dropped rather than converted, within
+    // the server's default queue of 4
+    constexpr int N_QUEUED = 3;
+    pvtui::MonitorTestAccess::hold_polling(pv);
+    for (int i = 0; i < N_QUEUED; i++) {
+        server.set(static_cast<double>(N_UPDATES + i));
+        server.post(shared_pv);
+    }
+    pvtui::MonitorTestAccess::release_polling(pv);
+    assert(pv.dropped_updates() == dropped + N_QUEUED - 1);
+    assert(pvgroup.dropped_updates() == pv.dropped_updates());
+    bool synced = sync_until(pvgroup, [&] { return counter == N_UPDATES + N_QUEUED - 1; });
+    assert(synced);
+    std::cout << "[pvtui::PVHandler] All tests passed" << std::endl;
+}
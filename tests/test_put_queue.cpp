@@ -0,0 +1,136 @@
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <ftxui/dom/node.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Writes to a mailbox PV on an in-process pvAccess server through PVHandler::put()
+// and checks that the result is reported through put_status() after sync().
+
+namespace {
+
+// Syncs the group until the PV has no puts in flight or the timeout expires
+bool wait_for_put(pvtui::PVGroup& pvgroup, pvtui::PVHandler& pv) {
+    return pvtui::test::sync_until(pvgroup,
+                                   [&] { return pv.put_status().state != pvtui::PutStatus::State::Pending; });
+}
+
+} // namespace
+
+int main() {
+
+    std::cout << "[pvtui::PutQueue] Running put tests...\n";
+
+    const std::string pv_name = "pvtui:put:setpoint";
+
+    pvtui::test::TestServer server("pvtui_put");
+    server.add(pv_name, true);
+
+    pvac::ClientProvider provider = server.client();
+    pvtui::PVGroup pvgroup(provider, {pv_name});
+    pvtui::PVHandler& pv = pvgroup.get_pv(pv_name);
+
+    double setpoint = 0.0;
+    pvgroup.set_monitor(pv_name, setpoint);
+
+    assert(pv.put_status().state == pvtui::PutStatus::State::Idle);
+
+    // Successful put, the new value comes back through the monitor
+    pv.put("value", 1.5);
+    assert(pv.put_status().state == pvtui::PutStatus::State::Pending);
+    bool done = wait_for_put(pvgroup, pv);
+    assert(done);
+    assert(pv.put_status().state == pvtui::PutStatus::State::Success);
+    for (int i = 0; i < 100 && setpoint != 1.5; i++) {
+        pvgroup.wait_for_data(std::chrono::milliseconds(100));
+        pvgroup.sync();
+    }
+    assert(setpoint == 1.5);
+    std::cout << "  put double: OK\n";
+
+    // Strings are converted to the field type
+    pv.put("value", std::string("2.25"));
+    done = wait_for_put(pvgroup, pv);
+    assert(done);
+    assert(pv.put_status().state == pvtui::PutStatus::State::Success);
+    std::cout << "  put string as double: OK\n";
+
+    // Failures are reported with a message instead of throwing
+    pv.put("no_such_field", 1);
+    done = wait_for_put(pvgroup, pv);
+    assert(done);
+    assert(pv.put_status().state == pvtui::PutStatus::State::Failed);
+    assert(!pv.put_status().message.empty());
+
+    pv.put("value", std::string("not a number"));
+    done = wait_for_put(pvgroup, pv);
+    assert(done);
+    assert(pv.put_status().state == pvtui::PutStatus::State::Failed);
+    std::cout << "  failed puts: OK\n";
+
+    // Rapid puts while one is in flight collapse into a single waiting put
+    constexpr int N_PUTS = 100;
+    for (int i = 1; i <= N_PUTS; i++) {
+        pv.put("value", static_cast<double>(i), pvtui::PutPolicy::LastValue);
+    }
+    assert(pvgroup.put_queue().coalesced() > 0);
+    done = wait_for_put(pvgroup, pv);
+    assert(done);
+    assert(pv.put_status().state == pvtui::PutStatus::State::Success);
+    for (int i = 0; i < 100 && setpoint != N_PUTS; i++) {
+        pvgroup.wait_for_data(std::chrono::milliseconds(100));
+        pvgroup.sync();
+    }
+    assert(setpoint == N_PUTS);
+    std::cout << "  coalesced " << pvgroup.put_queue().coalesced() << " of " << N_PUTS << " puts: OK\n";
+
+    // KeepAll puts are all sent, in order
+    const size_t coalesced = pvgroup.put_queue().coalesced();
+    for (int i = 1; i <= 10; i++) {
+        pv.put("value", -static_cast<double>(i), pvtui::PutPolicy::KeepAll);
+    }
+    assert(pvgroup.put_queue().coalesced() == coalesced);
+    done = wait_for_put(pvgroup, pv);
+    assert(done);
+    assert(pvgroup.put_queue().pending() == 0);
+    for (int i = 0; i < 100 && setpoint != -10.0; i++) {
+        pvgroup.wait_for_data(std::chrono::milliseconds(100));
+        pvgroup.sync();
+    }
+    assert(setpoint == -10.0);
+    std::cout << "  keep all puts: OK\n";
+
+    // A widget writing to the PV is drawn in the INVALID color while its last put failed
+    pvtui::InputWidget input(pvgroup, pv_name, pvtui::PVPutType::Double);
+    auto background = [&] {
+        auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(8), ftxui::Dimension::Fixed(1));
+        ftxui::Render(screen, input.component()->Render());
+        return screen.PixelAt(0, 0).background_color;
+    };
+    pv.put("value", std::string("not a number"));
+    done = wait_for_put(pvgroup, pv);
+    assert(done);
+    assert(input.put_status().state == pvtui::PutStatus::State::Failed);
+    assert(background() == ftxui::Color::Magenta);
+    pv.put("value", 4.0);
+    done = wait_for_put(pvgroup, pv);
+    assert(done);
+    assert(background() != ftxui::Color::Magenta);
+    std::cout << "  failed put style: OK\n";
+
+    // A put after the queue was stopped fails instead of staying pending
+    auto stopped = std::make_shared<pvtui::PutQueue>();
+    stopped->stop();
+    pvtui::PVHandler lone(provider, pv_name, nullptr, stopped);
+    lone.put("value", 3.0);
+    assert(lone.put_status().state == pvtui::PutStatus::State::Failed);
+    assert(stopped->pending() == 0);
+    std::cout << "  put to stopped queue: OK\n";
+
+    std::cout << "[pvtui::PutQueue] All tests passed" << std::endl;
+}
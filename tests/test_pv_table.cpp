@@ -0,0 +1,88 @@
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ftxui/component/event.hpp>
+#include <ftxui/component/mouse.hpp>
+#include <ftxui/dom/node.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Checks that a PVTable only monitors the rows within a page of its visible
+// window, that scrolling moves the monitored rows along, and that the mouse
+// wheel only scrolls it while the pointer is over it.
+
+namespace pvd = epics::pvData;
+
+using pvtui::test::sync_until;
+
+int main() {
+
+    std::cout << "[pvtui::PVTable] Running table tests...\n";
+
+    constexpr size_t N_ROWS = 200;
+    constexpr size_t HEIGHT = 10;
+
+    pvtui::test::TestServer server("pvtui_table", pvd::pvString);
+    std::vector<std::string> names;
+    for (size_t i = 0; i < N_ROWS; i++) {
+        names.push_back("pvtui:table:pv" + std::to_string(i));
+        server.set("value" + std::to_string(i));
+        server.add(names.back());
+    }
+
+    pvac::ClientProvider provider = server.client();
+    pvtui::PVGroup pvgroup(provider);
+    pvtui::PVTable table(pvgroup, names, HEIGHT);
+    assert(table.size() == N_ROWS);
+
+    // The first page and the one after it are monitored, the rest never connect
+    assert(table.monitored(0) && table.monitored(2 * HEIGHT - 1));
+    assert(!table.monitored(2 * HEIGHT));
+    bool synced = sync_until(pvgroup, [&] { return table.value(HEIGHT - 1) == "value9"; });
+    assert(synced);
+    assert(!pvgroup.get_pv(names[100]).connected());
+    assert(table.value(100).empty());
+
+    // Scrolling moves the monitored window with a page of margin on each side
+    table.scroll_to(100);
+    assert(table.first_row() == 100);
+    assert(!table.monitored(0) && !table.monitored(HEIGHT - 1));
+    assert(table.monitored(100 - HEIGHT) && table.monitored(100 + 2 * HEIGHT - 1));
+    assert(!table.monitored(100 + 2 * HEIGHT));
+    synced = sync_until(pvgroup, [&] { return table.value(100) == "value100"; });
+    assert(synced);
+
+    // Selecting a row scrolls just enough to show it
+    table.select(150);
+    assert(table.selected_row() == 150);
+    assert(table.first_row() == 150 + 1 - HEIGHT);
+    table.select(N_ROWS + 10);
+    assert(table.selected_row() == N_ROWS - 1);
+    assert(table.first_row() == N_ROWS - HEIGHT);
+    table.scroll_to(N_ROWS);
+    assert(table.first_row() == N_ROWS - HEIGHT);
+
+    // The wheel only scrolls the table when the pointer is over it
+    table.select(0);
+    auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(40), ftxui::Dimension::Fixed(2 * HEIGHT));
+    ftxui::Render(screen, table.component()->Render());
+    ftxui::Mouse mouse;
+    mouse.button = ftxui::Mouse::WheelDown;
+    mouse.motion = ftxui::Mouse::Pressed;
+    mouse.x = 1;
+    mouse.y = static_cast<int>(HEIGHT) + 5;
+    bool handled = table.component()->OnEvent(ftxui::Event::Mouse("", mouse));
+    assert(!handled);
+    assert(table.selected_row() == 0);
+    mouse.y = 1;
+    handled = table.component()->OnEvent(ftxui::Event::Mouse("", mouse));
+    assert(handled);
+    assert(table.selected_row() == 1);
+
+    std::cout << "[pvtui::PVTable] All tests passed" << std::endl;
+}
@@ -0,0 +1,94 @@
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Adds PVs to a PVGroup from several threads while another thread looks them up,
+// and checks that every PV ends up in the group exactly once, and that PVs
+// prepared in a batch stay disconnected until subscribed.
+
+using pvtui::test::sync_until;
+
+int main() {
+
+    std::cout << "[pvtui::PVGroup] Running concurrent add tests...\n";
+
+    constexpr int N_THREADS = 4;
+    constexpr int N_PER_THREAD = 250;
+
+    pvtui::test::TestServer server("pvtui_shards");
+    std::vector<std::string> names;
+    for (int i = 0; i < N_THREADS * N_PER_THREAD; i++) {
+        names.push_back("pvtui:shards:pv" + std::to_string(i));
+        server.add(names.back());
+    }
+
+    pvac::ClientProvider provider = server.client();
+    pvtui::PVGroup pvgroup(provider);
+
+    // Each writer adds its own names one at a time, plus the first name of every
+    // thread to race on the same entries
+    std::vector<std::thread> writers;
+    for (int t = 0; t < N_THREADS; t++) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < N_PER_THREAD; i++) {
+                pvgroup.add(names[t * N_PER_THREAD + i]);
+                pvgroup.add(names[(i % N_THREADS) * N_PER_THREAD]);
+            }
+        });
+    }
+
+    // The reader sees each name either missing or always as the same handler
+    std::atomic<bool> done{false};
+    std::vector<pvtui::PVHandler*> seen(names.size(), nullptr);
+    std::thread reader([&] {
+        while (!done.load()) {
+            for (size_t i = 0; i < names.size(); i++) {
+                try {
+                    pvtui::PVHandler* pv = &pvgroup.get_pv(names[i]);
+                    assert(seen[i] == nullptr || seen[i] == pv);
+                    seen[i] = pv;
+                } catch (const std::runtime_error&) {
+                    assert(seen[i] == nullptr);
+                }
+            }
+        }
+    });
+
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done.store(true);
+    reader.join();
+
+    for (size_t i = 0; i < names.size(); i++) {
+        pvtui::PVHandler& pv = pvgroup.get_pv(names[i]);
+        assert(pv.name == names[i]);
+        assert(seen[i] == nullptr || seen[i] == &pv);
+    }
+
+    // Adding a batch of existing names is a no-op
+    pvtui::PVHandler* first = &pvgroup[names.front()];
+    pvgroup.add(names);
+    assert(&pvgroup[names.front()] == first);
+
+    // PVs prepared in a batch connect only once subscribed
+    const std::vector<std::string> prepared = {"pvtui:shards:prepared0", "pvtui:shards:prepared1"};
+    for (const auto& name : prepared) {
+        server.add(name);
+    }
+    pvgroup.prepare(prepared);
+    double value = -1.0;
+    auto sub = pvgroup.subscribe(prepared[0], value);
+    bool synced = sync_until(pvgroup, [&] { return pvgroup[prepared[0]].connected(); });
+    assert(synced);
+    assert(!pvgroup[prepared[1]].connected());
+
+    std::cout << "[pvtui::PVGroup] All tests passed" << std::endl;
+}
@@ -0,0 +1,69 @@
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#include <ftxui/dom/elements.hpp>
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Checks that WidgetBase::cached() reuses the element it built until the widget's
+// PV is updated by PVGroup::sync(), and that other PVs don't invalidate it.
+
+using pvtui::test::sync_until;
+
+int main() {
+
+    std::cout << "[pvtui::WidgetBase] Running render cache tests...\n";
+
+    const std::string a_name = "pvtui:render:a";
+    const std::string b_name = "pvtui:render:b";
+
+    pvtui::test::TestServer server("pvtui_render_cache");
+    server.set(1.0);
+    auto a_pv = server.add(a_name);
+    auto b_pv = server.add(b_name);
+
+    pvac::ClientProvider provider = server.client();
+    pvtui::PVGroup pvgroup(provider);
+    pvtui::Monitor<double> a(pvgroup, a_name);
+    pvtui::Monitor<double> b(pvgroup, b_name);
+    bool synced = sync_until(pvgroup, [&] { return a.value() == 1.0 && b.value() == 1.0 && a.connected(); });
+    assert(synced);
+
+    int builds = 0;
+    auto render = [&] {
+        return a.cached([&] {
+            builds++;
+            return ftxui::text(std::to_string(a.value()));
+        });
+    };
+
+    // Built once, then reused
+    ftxui::Element first = render();
+    assert(builds == 1);
+    ftxui::Element element = render();
+    assert(element == first);
+    assert(builds == 1);
+
+    // An update of another PV keeps the cache
+    server.set(2.0);
+    server.post(b_pv);
+    synced = sync_until(pvgroup, [&] { return b.value() == 2.0; });
+    assert(synced);
+    element = render();
+    assert(element == first);
+    assert(builds == 1);
+
+    // An update of the widget's PV rebuilds it
+    const uint64_t generation = a.generation();
+    server.post(a_pv);
+    synced = sync_until(pvgroup, [&] { return a.value() == 2.0; });
+    assert(synced);
+    assert(a.generation() != generation);
+    element = render();
+    assert(element != first);
+    assert(builds == 2);
+
+    std::cout << "[pvtui::WidgetBase] All tests passed" << std::endl;
+}
@@ -0,0 +1,126 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <pvtui/pvtui.hpp>
+
+// Checks that RenderScheduler grants an idle frame at once, spaces frames by
+// max_fps, holds a burst until the current frame has finished, backs off when
+// frames are slow down to min_fps, and releases its waiters on stop().
+
+namespace {
+
+using std::chrono::milliseconds;
+using clock_type = pvtui::RenderScheduler::clock;
+
+// Runs one granted frame which takes the given time to render
+void render_frame(pvtui::RenderScheduler& scheduler, milliseconds duration) {
+    scheduler.frame_started();
+    std::this_thread::sleep_for(duration);
+    scheduler.frame_finished();
+}
+
+void test_spacing() {
+    pvtui::RenderOptions options;
+    options.max_fps = 50.0;
+    options.max_render_load = 0.0;
+    pvtui::RenderScheduler scheduler(options);
+    assert(scheduler.interval() == milliseconds(20));
+
+    // nothing was drawn yet, so the first frame is not delayed
+    auto t0 = clock_type::now();
+    bool granted = scheduler.wait_for_slot();
+    assert(granted);
+    assert(clock_type::now() - t0 < milliseconds(15));
+
+    t0 = clock_type::now();
+    render_frame(scheduler, milliseconds(0));
+    granted = scheduler.wait_for_slot();
+    assert(granted);
+    assert(clock_type::now() - t0 >= milliseconds(20));
+
+    // after a pause longer than the interval a frame starts at once again
+    render_frame(scheduler, milliseconds(0));
+    std::this_thread::sleep_for(milliseconds(40));
+    t0 = clock_type::now();
+    granted = scheduler.wait_for_slot();
+    assert(granted);
+    assert(clock_type::now() - t0 < milliseconds(15));
+}
+
+void test_burst() {
+    pvtui::RenderOptions options;
+    options.max_fps = 0.0;
+    options.max_render_load = 0.0;
+    pvtui::RenderScheduler scheduler(options);
+    assert(scheduler.interval() == clock_type::duration::zero());
+
+    const bool first = scheduler.wait_for_slot();
+    assert(first);
+    scheduler.frame_started();
+
+    // data arriving during a frame waits for it instead of queueing more frames
+    std::atomic<bool> granted = false;
+    std::thread waiter([&] { granted = scheduler.wait_for_slot(); });
+    std::this_thread::sleep_for(milliseconds(50));
+    assert(!granted);
+    scheduler.frame_finished();
+    waiter.join();
+    assert(granted);
+
+    // a granted frame which never started doesn't count as finished
+    scheduler.frame_finished();
+    std::atomic<bool> returned = false;
+    std::thread blocked([&] {
+        granted = scheduler.wait_for_slot();
+        returned = true;
+    });
+    std::this_thread::sleep_for(milliseconds(50));
+    assert(!returned);
+    scheduler.stop();
+    blocked.join();
+    assert(!granted);
+    const bool after_stop = scheduler.wait_for_slot();
+    assert(!after_stop);
+}
+
+void test_back_off() {
+    pvtui::RenderOptions options;
+    options.max_fps = 100.0;
+    options.min_fps = 1.0;
+    options.max_render_load = 0.5;
+    pvtui::RenderScheduler scheduler(options);
+    assert(scheduler.interval() == milliseconds(10));
+
+    // a 100 ms frame moves the average by a quarter, to 25 ms, so frames are
+    // spaced by 50 ms to keep rendering at half of the time
+    bool granted = scheduler.wait_for_slot();
+    assert(granted);
+    render_frame(scheduler, milliseconds(100));
+    assert(scheduler.render_duration() >= milliseconds(25));
+    assert(scheduler.interval() >= milliseconds(50));
+    assert(scheduler.interval() < milliseconds(100));
+
+    // min_fps caps the back-off
+    options.min_fps = 50.0;
+    pvtui::RenderScheduler capped(options);
+    granted = capped.wait_for_slot();
+    assert(granted);
+    render_frame(capped, milliseconds(100));
+    assert(capped.interval() == milliseconds(20));
+}
+
+} // namespace
+
+int main() {
+
+    std::cout << "[pvtui::RenderScheduler] Running tests...\n";
+
+    test_spacing();
+    test_burst();
+    test_back_off();
+
+    std::cout << "[pvtui::RenderScheduler] All tests passed" << std::endl;
+}
@@ -0,0 +1,111 @@
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Checks that PVs subscribed through PVGroup::subscribe() stay in the group while
+// a Subscription is held, stop updating released variables, and are removed from
+// the group with their last Subscription.
+
+namespace {
+
+using pvtui::test::sync_until;
+
+bool in_group(pvtui::PVGroup& pvgroup, const std::string& pv_name) {
+    try {
+        pvgroup.get_pv(pv_name);
+        return true;
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+}
+
+} // namespace
+
+int main() {
+
+    std::cout << "[pvtui::Subscription] Running subscription tests...\n";
+
+    const std::string pv_name = "pvtui:sub:value";
+    const std::string pinned_name = "pvtui:sub:pinned";
+
+    pvtui::test::TestServer server("pvtui_subscription");
+    server.set(1.0);
+    auto shared_pv = server.add(pv_name);
+    server.add(pinned_name);
+
+    pvac::ClientProvider provider = server.client();
+    pvtui::PVGroup pvgroup(provider);
+
+    // Two variables on the same PV
+    double a = 0.0;
+    double b = 0.0;
+    pvtui::Subscription sub_a = pvgroup.subscribe(pv_name, a);
+    pvtui::Subscription sub_b = pvgroup.subscribe(pv_name, b);
+    assert(sub_a && sub_b);
+    bool synced = sync_until(pvgroup, [&] { return a == 1.0 && b == 1.0; });
+    assert(synced);
+
+    // A released variable is no longer updated, the other one still is
+    sub_a.reset();
+    assert(!sub_a);
+    assert(in_group(pvgroup, pv_name));
+    server.set(2.0);
+    server.post(shared_pv);
+    synced = sync_until(pvgroup, [&] { return b == 2.0; });
+    assert(synced);
+    assert(a == 1.0);
+
+    // Copies share the subscription
+    pvtui::Subscription copy = sub_b;
+    sub_b.reset();
+    assert(in_group(pvgroup, pv_name));
+
+    // Releasing the last one removes the PV
+    copy.reset();
+    assert(!in_group(pvgroup, pv_name));
+    pvgroup.sync();
+
+    // Subscribing again creates a new handler which gets the current value
+    double c = 0.0;
+    pvtui::Subscription sub_c = pvgroup.subscribe(pv_name, c);
+    synced = sync_until(pvgroup, [&] { return c == 2.0; });
+    assert(synced);
+
+    // remove() drops the PV even with a Subscription held
+    bool removed = pvgroup.remove(pv_name);
+    assert(removed);
+    removed = pvgroup.remove(pv_name);
+    assert(!removed);
+    assert(!in_group(pvgroup, pv_name));
+    sub_c.reset();
+
+    // A PV added with add() stays after its subscriptions are released
+    pvgroup.add(pinned_name);
+    double d = 0.0;
+    pvtui::Subscription sub_d = pvgroup.subscribe(pinned_name, d);
+    synced = sync_until(pvgroup, [&] { return d == 1.0; });
+    assert(synced);
+    sub_d.reset();
+    assert(in_group(pvgroup, pinned_name));
+
+    // A widget claims its PV once, so a display captures a single Subscription for it
+    {
+        std::vector<pvtui::Subscription> captured;
+        pvgroup.begin_capture(captured);
+        pvtui::Monitor<double> widget(pvgroup, pv_name);
+        pvgroup.end_capture(captured, true);
+        assert(captured.size() == 1);
+        synced = sync_until(pvgroup, [&] { return widget.value() == 2.0; });
+        assert(synced);
+        captured.clear();
+        assert(in_group(pvgroup, pv_name));
+    }
+    assert(!in_group(pvgroup, pv_name));
+
+    std::cout << "[pvtui::Subscription] All tests passed" << std::endl;
+}
@@ -0,0 +1,60 @@
+#include <cassert>
+#include <iostream>
+
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Posts an update which only changes the timeStamp and checks that it is received
+// but neither converted nor synced, so widgets on the PV are not redrawn, and that
+// a later change of the value still is.
+
+namespace pvd = epics::pvData;
+
+using pvtui::test::sync_until;
+
+int main() {
+
+    std::cout << "[pvtui::PVHandler] Running unchanged update tests...\n";
+
+    const std::string pv_name = "pvtui:unchanged:rbv";
+
+    pvtui::test::TestServer server("pvtui_unchanged", pvtui::test::scalar_type(pvd::pvDouble, true));
+    server.set(1.0);
+    auto shared_pv = server.add(pv_name);
+    auto seconds = server.value->getSubFieldT<pvd::PVLong>("timeStamp.secondsPastEpoch");
+    pvd::BitSet timestamp_changed;
+    timestamp_changed.set(server.value->getSubFieldT<pvd::PVStructure>("timeStamp")->getFieldOffset());
+
+    pvac::ClientProvider provider = server.client();
+    pvtui::PVGroup pvgroup(provider);
+    // tracing adds timeStamp to the pvRequest, so the server sends timeStamp-only updates
+    pvgroup.trace_latency();
+    pvtui::Monitor<double> widget(pvgroup, pv_name);
+    pvtui::PVHandler& pv = pvgroup.get_pv(pv_name);
+    bool synced = sync_until(pvgroup, [&] { return widget.value() == 1.0; });
+    assert(synced);
+
+    // The in-process server calls back on the posting thread, so the update has
+    // arrived once post() returns
+    const uint64_t events = pv.monitor_events();
+    const uint64_t generation = widget.generation();
+    seconds->put(seconds->get() + 1);
+    shared_pv->post(*server.value, timestamp_changed);
+    assert(pv.monitor_events() == events + 1);
+    bool updated = pvgroup.sync();
+    assert(!updated);
+    assert(pvgroup.last_sync_pvs() == 0);
+    assert(widget.generation() == generation);
+
+    // A change of the value is converted and synced as before
+    server.set(2.0);
+    server.post(shared_pv);
+    assert(pv.monitor_events() == events + 2);
+    updated = pvgroup.sync();
+    assert(updated);
+    assert(widget.value() == 2.0);
+    assert(widget.generation() != generation);
+
+    std::cout << "[pvtui::PVHandler] All tests passed" << std::endl;
+}
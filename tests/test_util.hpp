@@ -0,0 +1,125 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include <pv/pvData.h>
+#include <pv/standardField.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pvtui/pvtui.hpp>
+
+// Helpers shared by the tests which run PVs on an in-process pvAccess server
+
+namespace pvtui::test {
+
+/**
+ * @brief Syncs the group until pred() is true or the timeout expires.
+ * @return True if pred() became true.
+ */
+template <typename Pred>
+bool sync_until(PVGroup& pvgroup, Pred pred, std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        pvgroup.wait_for_data(std::chrono::milliseconds(50));
+        pvgroup.sync();
+    }
+    return true;
+}
+
+/**
+ * @brief Creates an NTScalar structure type.
+ * @param type The type of the value field.
+ * @param timestamp Whether to add a timeStamp field.
+ */
+inline epics::pvData::StructureConstPtr scalar_type(epics::pvData::ScalarType type, bool timestamp = false) {
+    auto builder = epics::pvData::getFieldCreate()
+                       ->createFieldBuilder()
+                       ->setId("epics:nt/NTScalar:1.0")
+                       ->add("value", type);
+    if (timestamp) {
+        builder = builder->add("timeStamp", epics::pvData::getStandardField()->timeStamp());
+    }
+    return builder->createStructure();
+}
+
+/**
+ * @brief Creates an NTScalar structure.
+ * @param type The type of the value field.
+ */
+inline epics::pvData::PVStructurePtr make_scalar(epics::pvData::ScalarType type) {
+    return epics::pvData::getPVDataCreate()->createPVStructure(scalar_type(type));
+}
+
+/**
+ * @brief In-process pvAccess server whose PVs all share one structure.
+ *
+ * Each PV is opened with the current contents of value, and post() sends them
+ * to a PV with the value field marked as changed.
+ */
+class TestServer {
+  public:
+    /**
+     * @brief Creates a server for PVs of any structure.
+     * @param name Name of the server's provider.
+     * @param type The structure of every PV.
+     */
+    TestServer(const std::string& name, const epics::pvData::StructureConstPtr& type)
+        : value(epics::pvData::getPVDataCreate()->createPVStructure(type)), provider_(name) {
+        if (auto field = value->getSubField("value")) {
+            changed.set(field->getFieldOffset());
+        }
+    }
+
+    /**
+     * @brief Creates a server for NTScalar PVs.
+     * @param name Name of the server's provider.
+     * @param type The type of the value field.
+     */
+    explicit TestServer(const std::string& name, epics::pvData::ScalarType type = epics::pvData::pvDouble)
+        : TestServer(name, scalar_type(type)) {}
+
+    /**
+     * @brief Adds a PV holding the current contents of value.
+     * @param pv_name The PV name.
+     * @param mailbox Whether clients may write to the PV.
+     * @return The PV, for post().
+     */
+    pvas::SharedPV::shared_pointer add(const std::string& pv_name, bool mailbox = false) {
+        auto pv = mailbox ? pvas::SharedPV::buildMailbox() : pvas::SharedPV::buildReadOnly();
+        pv->open(*value);
+        provider_.add(pv_name, pv);
+        return pv;
+    }
+
+    /**
+     * @brief Sets the value field of value.
+     * @param v The new value, converted to the field's type.
+     */
+    template <typename T>
+    void set(const T& v) {
+        value->getSubFieldT<epics::pvData::PVScalar>("value")->template putFrom<T>(v);
+    }
+
+    /**
+     * @brief Sends value to a PV, with changed marking the fields it updates.
+     * @param pv A PV returned by add().
+     */
+    void post(const pvas::SharedPV::shared_pointer& pv) const { pv->post(*value, changed); }
+
+    /**
+     * @brief Creates a client provider connected to the server.
+     */
+    pvac::ClientProvider client() const { return pvac::ClientProvider(provider_.provider()); }
+
+    epics::pvData::PVStructurePtr value; ///< Contents PVs are opened and posted with.
+    epics::pvData::BitSet changed;       ///< Fields post() marks as changed, the value field by default.
+
+  private:
+    pvas::StaticProvider provider_; ///< The server's provider.
+};
+
+} // namespace pvtui::test
@@ -0,0 +1,101 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include <pvtui/pvtui.hpp>
+
+#include "test_util.hpp"
+
+// Checks that MonitorSlots converts one value into several types consistently, that
+// a number formatted as a string follows changes of the value and precision, and
+// that the value field is looked up again when the structure changes.
+
+namespace pvd = epics::pvData;
+
+using pvtui::test::make_scalar;
+
+int main() {
+
+    std::cout << "[pvtui::MonitorSlots] Running value conversion tests...\n";
+
+    pvtui::PVMetadata metadata;
+    metadata.precision = 3;
+
+    // A double read once into every numeric and string slot
+    auto dbl = make_scalar(pvd::pvDouble);
+    auto dval = dbl->getSubFieldT<pvd::PVDouble>("value");
+    double number = 0.0;
+    int integer = 0;
+    std::string text;
+    pvtui::MonitorSlots slots;
+    slots.add(number);
+    slots.add(integer);
+    slots.add(text);
+
+    dval->put(1.23456);
+    bool converted = slots.update(dbl, metadata);
+    assert(converted);
+    bool synced = slots.sync();
+    assert(synced);
+    assert(number == 1.23456);
+    assert(integer == 1);
+    assert(text == "1.235");
+
+    // The same number is formatted again when the precision changes
+    metadata.precision = 2;
+    converted = slots.update(dbl, metadata);
+    assert(converted);
+    synced = slots.sync();
+    assert(synced);
+    assert(text == "1.23");
+
+    // and when the value changes
+    dval->put(-2.5);
+    converted = slots.update(dbl, metadata);
+    assert(converted);
+    synced = slots.sync();
+    assert(synced);
+    assert(number == -2.5);
+    assert(integer == -2);
+    assert(text == "-2.50");
+
+    // Integers ignore the precision
+    auto lng = make_scalar(pvd::pvLong);
+    lng->getSubFieldT<pvd::PVLong>("value")->put(-7);
+    converted = slots.update(lng, metadata);
+    assert(converted);
+    synced = slots.sync();
+    assert(synced);
+    assert(number == -7.0);
+    assert(integer == -7);
+    assert(text == "-7");
+
+    // Strings still parse into numbers, or fail without touching them
+    auto str = make_scalar(pvd::pvString);
+    auto sval = str->getSubFieldT<pvd::PVString>("value");
+    sval->put("42");
+    converted = slots.update(str, metadata);
+    assert(converted);
+    synced = slots.sync();
+    assert(synced);
+    assert(number == 42.0 && integer == 42 && text == "42");
+
+    sval->put("n/a");
+    converted = slots.update(str, metadata);
+    assert(!converted);
+    synced = slots.sync();
+    assert(synced);
+    assert(slots.failed());
+    assert(number == 42.0 && integer == 42 && text == "n/a");
+
+    // Going back to an earlier structure looks its fields up again
+    dval->put(3.0);
+    converted = slots.update(dbl, metadata);
+    assert(converted);
+    synced = slots.sync();
+    assert(synced);
+    assert(!slots.failed());
+    assert(number == 3.0 && integer == 3 && text == "3.00");
+
+    std::cout << "[pvtui::MonitorSlots] All tests passed" << std::endl;
+}